@@ -8,6 +8,8 @@
 #include <SDL3_ttf/SDL_ttf.h>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <algorithm>
 
 /* Constants */
 //Screen dimension constants
@@ -25,11 +27,70 @@ bool loadMedia();
 //Frees media and shuts down SDL
 void close();
 
-class LTimer
+//Times scheduling, cancelling and a minute of frames with many active timers
+void runTimerWheelBenchmark( int timerCount );
+
+//Times querying, pausing and unpausing many LTimers against a timer pool
+void runTimerPoolBenchmark( int timerCount );
+
+//Reads the timer count following a benchmark flag, using the default if it is missing or not a positive number
+int parseTimerCount( int argc, char* args[], int flagIndex, int defaultCount );
+
+class LClock
+{
+    public:
+        //Cleans up the clock
+        virtual ~LClock() = default;
+
+        //Gets the clock's time
+        virtual Uint64 getTicksNS() = 0;
+
+        //Waits for an amount of the clock's time
+        virtual void delayNS( Uint64 ns ) = 0;
+
+        //Checks if time only moves when asked to, busy waiting on these never ends
+        virtual bool isVirtual();
+};
+
+class LRealClock : public LClock
+{
+    public:
+        //Wall clock time since SDL started
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+};
+
+class LScaledClock : public LClock
 {
     public:
         //Initializes variables
-        LTimer();
+        LScaledClock( LClock& source, double scale );
+
+        //Changes speed without making time jump
+        void setScale( double scale );
+        double getScale();
+
+        //Source time multiplied by the scale
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+
+    private:
+        //Clock being scaled
+        LClock& mSource;
+
+        //Time multiplier
+        double mScale;
+
+        //Source and scaled time when the scale last changed
+        Uint64 mSourceAnchor;
+        Uint64 mTicksAnchor;
+};
+
+class LTimer
+{
+    public:
+        //Initializes variables, timers read the global clock unless given their own
+        LTimer( LClock* clock = nullptr );
 
         //The various clock actions
         void start();
@@ -44,7 +105,13 @@ class LTimer
         bool isStarted();
         bool isPaused();
 
+        //Gets the clock the timer reads
+        LClock* getClock();
+
     private:
+        //Clock this timer always reads, null to follow the global clock
+        LClock* mClock;
+
         //The clock time when the timer started
         Uint64 mStartTicks;
 
@@ -56,6 +123,174 @@ class LTimer
         bool mStarted;
 };
 
+//Runs when a scheduled timer expires
+using LTimerCallback = void (*)( void* userData );
+
+//Refers to a scheduled timer, stays safe to use after the timer fires or is cancelled
+struct LTimerHandle
+{
+    int index;
+    Uint32 generation;
+};
+
+class LTimerWheel
+{
+    public:
+        //Four levels of 256 slots cover 2^32 ticks
+        static constexpr int kLevels = 4;
+        static constexpr int kSlotBits = 8;
+        static constexpr int kSlotsPerLevel = 1 << kSlotBits;
+
+        //Initializes variables
+        LTimerWheel();
+
+        //Starts the wheel clock, timers expire on multiples of the tick length
+        void start( Uint64 tickNs = 1000000 );
+
+        //Freezes and resumes expiry the same way LTimer pauses
+        void pause();
+        void unpause();
+        bool isPaused();
+
+        //Schedules a callback after a delay, repeating at the interval if it isn't zero
+        LTimerHandle schedule( Uint64 delayNs, LTimerCallback callback, void* userData, Uint64 intervalNs = 0 );
+
+        //Removes a timer before it fires, returns false if it already fired or was cancelled
+        bool cancel( LTimerHandle handle );
+        bool isScheduled( LTimerHandle handle );
+
+        //Reads the clock once and fires everything due, returns the number fired
+        int update();
+
+        //Fires everything due up to a wheel time, used by update and benchmarks
+        int advanceTo( Uint64 timeNs );
+
+        //Gets the number of scheduled timers
+        int getActiveCount();
+
+        //Preallocates timer storage
+        void reserve( int timerCount );
+
+    private:
+        //A scheduled timer linked into one slot
+        struct LWheelTimer
+        {
+            Uint64 expiryTick;
+            Uint64 intervalTicks;
+            LTimerCallback callback;
+            void* userData;
+            int prev;
+            int next;
+            int slot;
+            Uint32 generation;
+        };
+
+        //Extra list holding timers that are being fired
+        static constexpr int kFiringSlot = kLevels * kSlotsPerLevel;
+
+        //Links a timer into the slot its expiry falls in
+        void insert( int index );
+
+        //Unlinks a timer from its slot
+        void unlink( int index );
+
+        //Moves a slot's timers into finer levels
+        void cascade( int level );
+
+        //Clock the wheel runs on
+        LTimer mClock;
+
+        //Tick length and the last tick processed
+        Uint64 mTickNs;
+        Uint64 mCurrentTick;
+
+        //Timer storage, freed entries chain through next
+        std::vector<LWheelTimer> mTimers;
+        int mFreeHead;
+        int mActiveCount;
+
+        //First timer in each slot plus the firing list
+        int mSlotHeads[ kFiringSlot + 1 ];
+};
+
+class LTimerPool;
+
+//Lightweight handle with the LTimer interface, times are as of the pool's last frame sample
+class LPooledTimer
+{
+    public:
+        //Initializes variables
+        LPooledTimer();
+        LPooledTimer( LTimerPool* pool, int index );
+
+        //The various clock actions
+        void start();
+        void stop();
+        void pause();
+        void unpause();
+
+        //Gets the timer's time
+        Uint64 getTicksNS();
+
+        //Checks the status of the timer
+        bool isStarted();
+        bool isPaused();
+
+        //Gets the slot in the pool
+        int getIndex();
+
+    private:
+        //Pool the timer lives in
+        LTimerPool* mPool;
+        int mIndex;
+};
+
+class LTimerPool
+{
+    public:
+        //Initializes variables
+        LTimerPool();
+
+        //Hands out a stopped timer
+        LPooledTimer create();
+
+        //Returns a timer's slot to the pool
+        void release( LPooledTimer timer );
+
+        //Reads the clock once for every timer operation until the next frame
+        void beginFrame();
+
+        //Single timer actions at the sampled time
+        void start( int index );
+        void stop( int index );
+        void pause( int index );
+        void unpause( int index );
+        Uint64 getTicksNS( int index );
+        bool isStarted( int index );
+        bool isPaused( int index );
+
+        //Acts on every timer in one pass without branches
+        void pauseAll();
+        void unpauseAll();
+        void getAllTicksNS( Uint64* ticks );
+
+        //Gets the number of slots including released ones
+        int getCapacity();
+
+    private:
+        //Clock sampled at the start of the frame
+        Uint64 mNow;
+
+        //Ticks are ( now & running mask ) - offset,
+        //running timers keep their start time as the offset and paused ones the negated paused time
+        std::vector<Uint64> mOffsets;
+        std::vector<Uint64> mRunningMasks;
+        std::vector<Uint64> mStartedMasks;
+
+        //Released slots
+        std::vector<int> mFreeSlots;
+};
+
 
 class LButton
 {
@@ -160,11 +395,71 @@ TTF_Font* gFont{ nullptr };
 //The directional images
 LTexture gTimeTextTexture;
 
+//Wall clock, used directly by anything measuring real cost
+LRealClock gRealClock;
+
+//Clock timers and pacers read, scaled with --time-scale
+LClock* gClock{ &gRealClock };
+
 
 
 /* Class Implementations */
+//LClock Implementation
+bool LClock::isVirtual()
+{
+    return false;
+}
+
+
+//LRealClock Implementation
+Uint64 LRealClock::getTicksNS()
+{
+    return SDL_GetTicksNS();
+}
+
+void LRealClock::delayNS( Uint64 ns )
+{
+    SDL_DelayNS( ns );
+}
+
+
+//LScaledClock Implementation
+LScaledClock::LScaledClock( LClock& source, double scale ):
+    mSource( source ),
+    mScale{ scale },
+    mSourceAnchor{ source.getTicksNS() },
+    mTicksAnchor{ 0 }
+{
+
+}
+
+void LScaledClock::setScale( double scale )
+{
+    //Keep the time so far and scale from here on
+    mTicksAnchor = getTicksNS();
+    mSourceAnchor = mSource.getTicksNS();
+    mScale = scale;
+}
+
+double LScaledClock::getScale()
+{
+    return mScale;
+}
+
+Uint64 LScaledClock::getTicksNS()
+{
+    return mTicksAnchor + static_cast<Uint64>( ( mSource.getTicksNS() - mSourceAnchor ) * mScale );
+}
+
+void LScaledClock::delayNS( Uint64 ns )
+{
+    mSource.delayNS( static_cast<Uint64>( ns / mScale ) );
+}
+
+
 //LTimer Implementation
-LTimer::LTimer():
+LTimer::LTimer( LClock* clock ):
+    mClock{ clock },
     mStartTicks{ 0 },
     mPausedTicks{ 0 },
 
@@ -183,7 +478,7 @@ void LTimer::start()
     mPaused = false;
 
     //Get the current clock time
-    mStartTicks = SDL_GetTicksNS();
+    mStartTicks = getClock()->getTicksNS();
     mPausedTicks = 0;
 }
 
@@ -209,7 +504,7 @@ void LTimer::pause()
         mPaused = true;
 
         //Calculate the paused ticks
-        mPausedTicks = SDL_GetTicksNS() - mStartTicks;
+        mPausedTicks = getClock()->getTicksNS() - mStartTicks;
         mStartTicks = 0;
     }
 }
@@ -223,7 +518,7 @@ void LTimer::unpause()
         mPaused = false;
 
         //Reset the starting ticks
-        mStartTicks = SDL_GetTicksNS() - mPausedTicks;
+        mStartTicks = getClock()->getTicksNS() - mPausedTicks;
 
         //Reset the paused ticks
         mPausedTicks = 0;
@@ -247,7 +542,7 @@ Uint64 LTimer::getTicksNS()
         else
         {
             //Return the current time minus the start time
-            time = SDL_GetTicksNS() - mStartTicks;
+            time = getClock()->getTicksNS() - mStartTicks;
         }
     }
 
@@ -264,6 +559,414 @@ bool LTimer::isStarted()
     return mStarted;
 }
 
+LClock* LTimer::getClock()
+{
+    return mClock != nullptr ? mClock : gClock;
+}
+
+//LTimerWheel Implementation
+LTimerWheel::LTimerWheel():
+    mTickNs{ 1000000 },
+    mCurrentTick{ 0 },
+    mFreeHead{ -1 },
+    mActiveCount{ 0 }
+{
+    std::fill( mSlotHeads, mSlotHeads + kFiringSlot + 1, -1 );
+}
+
+void LTimerWheel::start( Uint64 tickNs )
+{
+    //Drop anything scheduled before
+    mTimers.clear();
+    mFreeHead = -1;
+    mActiveCount = 0;
+    std::fill( mSlotHeads, mSlotHeads + kFiringSlot + 1, -1 );
+
+    mTickNs = tickNs;
+    mCurrentTick = 0;
+    mClock.start();
+}
+
+void LTimerWheel::pause()
+{
+    mClock.pause();
+}
+
+void LTimerWheel::unpause()
+{
+    mClock.unpause();
+}
+
+bool LTimerWheel::isPaused()
+{
+    return mClock.isPaused();
+}
+
+LTimerHandle LTimerWheel::schedule( Uint64 delayNs, LTimerCallback callback, void* userData, Uint64 intervalNs )
+{
+    //Reuse a freed entry if there is one
+    int index{ mFreeHead };
+    if( index != -1 )
+    {
+        mFreeHead = mTimers[ index ].next;
+    }
+    else
+    {
+        index = static_cast<int>( mTimers.size() );
+        mTimers.push_back( LWheelTimer{} );
+    }
+
+    //Round up so timers never fire early, and always at least one tick out
+    LWheelTimer& timer{ mTimers[ index ] };
+    timer.expiryTick = mCurrentTick + SDL_max( ( delayNs + mTickNs - 1 ) / mTickNs, static_cast<Uint64>( 1 ) );
+    timer.intervalTicks = intervalNs == 0 ? 0 : SDL_max( ( intervalNs + mTickNs - 1 ) / mTickNs, static_cast<Uint64>( 1 ) );
+    timer.callback = callback;
+    timer.userData = userData;
+    insert( index );
+    ++mActiveCount;
+
+    return LTimerHandle{ index, timer.generation };
+}
+
+bool LTimerWheel::cancel( LTimerHandle handle )
+{
+    if( isScheduled( handle ) == false )
+    {
+        return false;
+    }
+
+    //Unlink and retire the entry, the new generation invalidates old handles
+    unlink( handle.index );
+    LWheelTimer& timer{ mTimers[ handle.index ] };
+    ++timer.generation;
+    timer.slot = -1;
+    timer.next = mFreeHead;
+    mFreeHead = handle.index;
+    --mActiveCount;
+    return true;
+}
+
+bool LTimerWheel::isScheduled( LTimerHandle handle )
+{
+    return handle.index >= 0 && handle.index < static_cast<int>( mTimers.size() )
+        && mTimers[ handle.index ].generation == handle.generation && mTimers[ handle.index ].slot != -1;
+}
+
+int LTimerWheel::update()
+{
+    return advanceTo( mClock.getTicksNS() );
+}
+
+int LTimerWheel::advanceTo( Uint64 timeNs )
+{
+    int fired{ 0 };
+    const Uint64 targetTick{ timeNs / mTickNs };
+    while( mCurrentTick < targetTick )
+    {
+        ++mCurrentTick;
+
+        //When a level wraps, pull the next coarser slot down, coarsest first so timers settle in one pass
+        int wrappedLevels{ 0 };
+        while( wrappedLevels < kLevels - 1 && ( ( mCurrentTick >> ( kSlotBits * ( wrappedLevels + 1 ) ) ) << ( kSlotBits * ( wrappedLevels + 1 ) ) ) == mCurrentTick )
+        {
+            ++wrappedLevels;
+        }
+        for( int level = wrappedLevels; level > 0; --level )
+        {
+            cascade( level );
+        }
+
+        //Move this tick's slot to the firing list so callbacks can schedule and cancel freely
+        int slot{ static_cast<int>( mCurrentTick & ( kSlotsPerLevel - 1 ) ) };
+        mSlotHeads[ kFiringSlot ] = mSlotHeads[ slot ];
+        mSlotHeads[ slot ] = -1;
+        for( int index = mSlotHeads[ kFiringSlot ]; index != -1; index = mTimers[ index ].next )
+        {
+            mTimers[ index ].slot = kFiringSlot;
+        }
+
+        while( mSlotHeads[ kFiringSlot ] != -1 )
+        {
+            int index{ mSlotHeads[ kFiringSlot ] };
+            LWheelTimer& timer{ mTimers[ index ] };
+            LTimerHandle handle{ index, timer.generation };
+            LTimerCallback callback{ timer.callback };
+            void* userData{ timer.userData };
+
+            //Rearm repeating timers, retire the rest before the callback can reuse the entry
+            if( timer.intervalTicks != 0 )
+            {
+                unlink( index );
+                timer.expiryTick = mCurrentTick + timer.intervalTicks;
+                insert( index );
+            }
+            else
+            {
+                cancel( handle );
+            }
+
+            callback( userData );
+            ++fired;
+        }
+    }
+
+    return fired;
+}
+
+int LTimerWheel::getActiveCount()
+{
+    return mActiveCount;
+}
+
+void LTimerWheel::reserve( int timerCount )
+{
+    mTimers.reserve( timerCount );
+}
+
+void LTimerWheel::insert( int index )
+{
+    //The coarsest level needed is set by how far away expiry is
+    LWheelTimer& timer{ mTimers[ index ] };
+    Uint64 delta{ timer.expiryTick - mCurrentTick };
+    int level{ 0 };
+    while( level < kLevels - 1 && delta >= ( static_cast<Uint64>( 1 ) << ( kSlotBits * ( level + 1 ) ) ) )
+    {
+        ++level;
+    }
+
+    //Timers past the wheel's span wait in the last slot of the top level and cascade again later
+    Uint64 expiry{ timer.expiryTick };
+    if( delta >= ( static_cast<Uint64>( 1 ) << ( kSlotBits * kLevels ) ) )
+    {
+        expiry = mCurrentTick + ( static_cast<Uint64>( 1 ) << ( kSlotBits * kLevels ) ) - 1;
+    }
+    int slot{ level * kSlotsPerLevel + static_cast<int>( ( expiry >> ( kSlotBits * level ) ) & ( kSlotsPerLevel - 1 ) ) };
+
+    //Push onto the front of the slot
+    timer.slot = slot;
+    timer.prev = -1;
+    timer.next = mSlotHeads[ slot ];
+    if( timer.next != -1 )
+    {
+        mTimers[ timer.next ].prev = index;
+    }
+    mSlotHeads[ slot ] = index;
+}
+
+void LTimerWheel::unlink( int index )
+{
+    LWheelTimer& timer{ mTimers[ index ] };
+    if( timer.prev != -1 )
+    {
+        mTimers[ timer.prev ].next = timer.next;
+    }
+    else
+    {
+        mSlotHeads[ timer.slot ] = timer.next;
+    }
+
+    if( timer.next != -1 )
+    {
+        mTimers[ timer.next ].prev = timer.prev;
+    }
+}
+
+void LTimerWheel::cascade( int level )
+{
+    //Detach the slot the current tick points at and reinsert relative to now
+    int slot{ level * kSlotsPerLevel + static_cast<int>( ( mCurrentTick >> ( kSlotBits * level ) ) & ( kSlotsPerLevel - 1 ) ) };
+    int index{ mSlotHeads[ slot ] };
+    mSlotHeads[ slot ] = -1;
+    while( index != -1 )
+    {
+        int next{ mTimers[ index ].next };
+        insert( index );
+        index = next;
+    }
+}
+
+//LPooledTimer Implementation
+LPooledTimer::LPooledTimer():
+    mPool{ nullptr },
+    mIndex{ -1 }
+{
+
+}
+
+LPooledTimer::LPooledTimer( LTimerPool* pool, int index ):
+    mPool{ pool },
+    mIndex{ index }
+{
+
+}
+
+void LPooledTimer::start()
+{
+    mPool->start( mIndex );
+}
+
+void LPooledTimer::stop()
+{
+    mPool->stop( mIndex );
+}
+
+void LPooledTimer::pause()
+{
+    mPool->pause( mIndex );
+}
+
+void LPooledTimer::unpause()
+{
+    mPool->unpause( mIndex );
+}
+
+Uint64 LPooledTimer::getTicksNS()
+{
+    return mPool->getTicksNS( mIndex );
+}
+
+bool LPooledTimer::isStarted()
+{
+    return mPool->isStarted( mIndex );
+}
+
+bool LPooledTimer::isPaused()
+{
+    return mPool->isPaused( mIndex );
+}
+
+int LPooledTimer::getIndex()
+{
+    return mIndex;
+}
+
+
+//LTimerPool Implementation
+LTimerPool::LTimerPool():
+    mNow{ 0 }
+{
+
+}
+
+LPooledTimer LTimerPool::create()
+{
+    //Reuse a released slot if there is one
+    int index{ 0 };
+    if( mFreeSlots.empty() == false )
+    {
+        index = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        index = static_cast<int>( mOffsets.size() );
+        mOffsets.push_back( 0 );
+        mRunningMasks.push_back( 0 );
+        mStartedMasks.push_back( 0 );
+    }
+
+    stop( index );
+    return LPooledTimer{ this, index };
+}
+
+void LTimerPool::release( LPooledTimer timer )
+{
+    stop( timer.getIndex() );
+    mFreeSlots.push_back( timer.getIndex() );
+}
+
+void LTimerPool::beginFrame()
+{
+    mNow = gClock->getTicksNS();
+}
+
+void LTimerPool::start( int index )
+{
+    mOffsets[ index ] = mNow;
+    mRunningMasks[ index ] = ~static_cast<Uint64>( 0 );
+    mStartedMasks[ index ] = ~static_cast<Uint64>( 0 );
+}
+
+void LTimerPool::stop( int index )
+{
+    mOffsets[ index ] = 0;
+    mRunningMasks[ index ] = 0;
+    mStartedMasks[ index ] = 0;
+}
+
+void LTimerPool::pause( int index )
+{
+    //Running timers keep their elapsed time, anything else is untouched
+    mOffsets[ index ] -= mNow & mRunningMasks[ index ];
+    mRunningMasks[ index ] = 0;
+}
+
+void LTimerPool::unpause( int index )
+{
+    //Paused timers carry on from their paused time, stopped ones stay stopped
+    mOffsets[ index ] += mNow & mStartedMasks[ index ] & ~mRunningMasks[ index ];
+    mRunningMasks[ index ] = mStartedMasks[ index ];
+}
+
+Uint64 LTimerPool::getTicksNS( int index )
+{
+    return ( mNow & mRunningMasks[ index ] ) - mOffsets[ index ];
+}
+
+bool LTimerPool::isStarted( int index )
+{
+    return mStartedMasks[ index ] != 0;
+}
+
+bool LTimerPool::isPaused( int index )
+{
+    return mStartedMasks[ index ] != 0 && mRunningMasks[ index ] == 0;
+}
+
+void LTimerPool::pauseAll()
+{
+    const Uint64 now{ mNow };
+    const int count{ getCapacity() };
+    Uint64* offsets{ mOffsets.data() };
+    Uint64* runningMasks{ mRunningMasks.data() };
+    for( int i = 0; i < count; ++i )
+    {
+        offsets[ i ] -= now & runningMasks[ i ];
+        runningMasks[ i ] = 0;
+    }
+}
+
+void LTimerPool::unpauseAll()
+{
+    const Uint64 now{ mNow };
+    const int count{ getCapacity() };
+    Uint64* offsets{ mOffsets.data() };
+    Uint64* runningMasks{ mRunningMasks.data() };
+    const Uint64* startedMasks{ mStartedMasks.data() };
+    for( int i = 0; i < count; ++i )
+    {
+        offsets[ i ] += now & startedMasks[ i ] & ~runningMasks[ i ];
+        runningMasks[ i ] = startedMasks[ i ];
+    }
+}
+
+void LTimerPool::getAllTicksNS( Uint64* ticks )
+{
+    const Uint64 now{ mNow };
+    const int count{ getCapacity() };
+    const Uint64* offsets{ mOffsets.data() };
+    const Uint64* runningMasks{ mRunningMasks.data() };
+    for( int i = 0; i < count; ++i )
+    {
+        ticks[ i ] = ( now & runningMasks[ i ] ) - offsets[ i ];
+    }
+}
+
+int LTimerPool::getCapacity()
+{
+    return static_cast<int>( mOffsets.size() );
+}
+
 //LButton Implementation
 LButton::LButton():
     mPosition{ 0.f, 0.f },
@@ -604,11 +1307,198 @@ void close()
 }
 
 
+void runTimerWheelBenchmark( int timerCount )
+{
+    //Same seed every run so results compare
+    SDL_srand( 1 );
+    int fired{ 0 };
+    auto countFired{ []( void* userData ) { ++*static_cast<int*>( userData ); } };
+
+    LTimerWheel wheel;
+    wheel.start();
+    wheel.reserve( timerCount );
+
+    //Schedule timers up to a minute out
+    constexpr Uint64 kSpanNs{ 60000000000 };
+    std::vector<LTimerHandle> handles( timerCount );
+    Uint64 startNs{ SDL_GetTicksNS() };
+    for( int i = 0; i < timerCount; ++i )
+    {
+        handles[ i ] = wheel.schedule( ( 1 + static_cast<Uint64>( SDL_rand( 60000 ) ) ) * 1000000, countFired, &fired );
+    }
+    Uint64 scheduleNs{ SDL_GetTicksNS() - startNs };
+
+    //Cancel every tenth timer
+    startNs = SDL_GetTicksNS();
+    int cancelled{ 0 };
+    for( int i = 0; i < timerCount; i += 10 )
+    {
+        cancelled += wheel.cancel( handles[ i ] ) ? 1 : 0;
+    }
+    Uint64 cancelNs{ SDL_GetTicksNS() - startNs };
+
+    //Polling baseline, a frame loop checking every running LTimer against its duration
+    std::vector<LTimer> timers( timerCount );
+    std::vector<Uint64> durations( timerCount );
+    for( int i = 0; i < timerCount; ++i )
+    {
+        durations[ i ] = ( 1 + static_cast<Uint64>( SDL_rand( 60000 ) ) ) * 1000000;
+        timers[ i ].start();
+    }
+    constexpr int kPollFrames = 60;
+    int due{ 0 };
+    startNs = SDL_GetTicksNS();
+    for( int frame = 0; frame < kPollFrames; ++frame )
+    {
+        for( int i = 0; i < timerCount; ++i )
+        {
+            if( timers[ i ].isStarted() && timers[ i ].getTicksNS() >= durations[ i ] )
+            {
+                timers[ i ].stop();
+                ++due;
+            }
+        }
+    }
+    Uint64 pollNs{ ( SDL_GetTicksNS() - startNs ) / kPollFrames };
+
+    //Run a minute of 60 fps frames
+    constexpr Uint64 kFrameNs{ 1000000000 / 60 };
+    Uint64 totalNs{ 0 }, worstNs{ 0 };
+    int frames{ 0 };
+    for( Uint64 timeNs = kFrameNs; timeNs <= kSpanNs + kFrameNs; timeNs += kFrameNs, ++frames )
+    {
+        startNs = SDL_GetTicksNS();
+        wheel.advanceTo( timeNs );
+        Uint64 frameNs{ SDL_GetTicksNS() - startNs };
+        totalNs += frameNs;
+        worstNs = SDL_max( worstNs, frameNs );
+    }
+
+    SDL_Log( "Timer wheel, %d timers: schedule %.1f ns each, cancel %.1f ns each (%d cancelled)\n",
+        timerCount, static_cast<double>( scheduleNs ) / timerCount, static_cast<double>( cancelNs ) / SDL_max( cancelled, 1 ), cancelled );
+    SDL_Log( "Timer wheel frames: %d, mean %.3f ms, worst %.3f ms, fired %d, still active %d\n",
+        frames, totalNs / 1000000.0 / frames, worstNs / 1000000.0, fired, wheel.getActiveCount() );
+    SDL_Log( "Polling every LTimer: %.3f ms per frame over %d frames (%d due)\n", pollNs / 1000000.0, kPollFrames, due );
+}
+
+void runTimerPoolBenchmark( int timerCount )
+{
+    //Individual timers, each call reads the clock and branches on its flags
+    std::vector<LTimer> timers( timerCount );
+    std::vector<Uint64> ticks( timerCount );
+    for( auto& timer : timers )
+    {
+        timer.start();
+    }
+
+    Uint64 startNs{ SDL_GetTicksNS() };
+    for( int i = 0; i < timerCount; ++i )
+    {
+        ticks[ i ] = timers[ i ].getTicksNS();
+    }
+    Uint64 timerQueryNs{ SDL_GetTicksNS() - startNs };
+
+    startNs = SDL_GetTicksNS();
+    for( auto& timer : timers )
+    {
+        timer.pause();
+    }
+    for( auto& timer : timers )
+    {
+        timer.unpause();
+    }
+    Uint64 timerPauseNs{ SDL_GetTicksNS() - startNs };
+
+    //The pool samples the clock once and sweeps its arrays
+    LTimerPool pool;
+    pool.beginFrame();
+    for( int i = 0; i < timerCount; ++i )
+    {
+        pool.create().start();
+    }
+
+    startNs = SDL_GetTicksNS();
+    pool.beginFrame();
+    pool.getAllTicksNS( ticks.data() );
+    Uint64 poolQueryNs{ SDL_GetTicksNS() - startNs };
+
+    startNs = SDL_GetTicksNS();
+    pool.pauseAll();
+    pool.beginFrame();
+    pool.unpauseAll();
+    Uint64 poolPauseNs{ SDL_GetTicksNS() - startNs };
+
+    SDL_Log( "%d timers, query all: LTimer %.3f ms, pool %.3f ms\n", timerCount, timerQueryNs / 1000000.0, poolQueryNs / 1000000.0 );
+    SDL_Log( "%d timers, pause and unpause all: LTimer %.3f ms, pool %.3f ms\n", timerCount, timerPauseNs / 1000000.0, poolPauseNs / 1000000.0 );
+}
+
+int parseTimerCount( int argc, char* args[], int flagIndex, int defaultCount )
+{
+    //Keep the benchmark's arrays within reason
+    constexpr long kMaxTimerCount = 50000000;
+
+    //No count given
+    if( flagIndex + 1 >= argc || SDL_strncmp( args[ flagIndex + 1 ], "--", 2 ) == 0 )
+    {
+        return defaultCount;
+    }
+
+    //The whole argument has to be a positive number
+    char* end{ nullptr };
+    long count{ SDL_strtol( args[ flagIndex + 1 ], &end, 10 ) };
+    if( end == args[ flagIndex + 1 ] || *end != '\0' || count <= 0 )
+    {
+        SDL_Log( "Invalid timer count %s, using %d\n", args[ flagIndex + 1 ], defaultCount );
+        return defaultCount;
+    }
+    if( count > kMaxTimerCount )
+    {
+        SDL_Log( "Timer count %ld is too large, using %ld\n", count, kMaxTimerCount );
+        count = kMaxTimerCount;
+    }
+
+    return static_cast<int>( count );
+}
+
 int main( int argc, char* args[] )
 {
     //Final exit code
     int exitCode{ 0 };
 
+    //Run timers faster or slower than real time if asked
+    LScaledClock scaledClock{ gRealClock, 1.0 };
+    for( int i = 1; i < argc; ++i )
+    {
+        if( SDL_strcmp( args[ i ], "--time-scale" ) == 0 && i + 1 < argc )
+        {
+            double scale{ SDL_atof( args[ ++i ] ) };
+            if( scale > 0.0 )
+            {
+                scaledClock.setScale( scale );
+                gClock = &scaledClock;
+            }
+            else
+            {
+                SDL_Log( "Time scale %s is not positive, using the real clock\n", args[ i ] );
+            }
+        }
+    }
+
+    //Benchmark the timer wheel instead of opening a window
+    for( int i = 1; i < argc; ++i )
+    {
+        if( SDL_strcmp( args[ i ], "--timer-bench" ) == 0 )
+        {
+            runTimerWheelBenchmark( parseTimerCount( argc, args, i, 1000000 ) );
+            return exitCode;
+        }
+        else if( SDL_strcmp( args[ i ], "--timer-pool-bench" ) == 0 )
+        {
+            runTimerPoolBenchmark( parseTimerCount( argc, args, i, 100000 ) );
+            return exitCode;
+        }
+    }
+
     //Initialize
     if( init() == false )
     {
@@ -650,6 +1540,12 @@ int main( int argc, char* args[] )
             //Application Timer
             LTimer timer;
 
+            //Scheduled callbacks that follow the application timer's start, stop and pause
+            LTimerWheel timerWheel;
+            LTimerHandle secondTimer{ -1, 0 };
+            int wheelSeconds{ 0 };
+            auto countSecond{ []( void* userData ) { ++*static_cast<int*>( userData ); } };
+
             //In memory text stream
             std::stringstream timeText;
 
@@ -675,10 +1571,14 @@ int main( int argc, char* args[] )
                             if( timer.isStarted() )
                             {
                                 timer.stop();
+                                timerWheel.cancel( secondTimer );
                             }
                             else
                             {
                                 timer.start();
+                                timerWheel.start();
+                                wheelSeconds = 0;
+                                secondTimer = timerWheel.schedule( 1000000000, countSecond, &wheelSeconds, 1000000000 );
                             }
                         }
                         //Pause/unpause
@@ -687,10 +1587,12 @@ int main( int argc, char* args[] )
                             if( timer.isPaused() )
                             {
                                 timer.unpause();
+                                timerWheel.unpause();
                             }
                             else
                             {
                                 timer.pause();
+                                timerWheel.pause();
                             }
                         }
                     }
@@ -711,11 +1613,14 @@ int main( int argc, char* args[] )
                     // }
                 }
 
+                //Fire due callbacks
+                timerWheel.update();
+
                 //If the timer has started
                 
                 //Update text
                 timeText.str("");
-                timeText << "Milliseconds since start time " << ( timer.getTicksNS() / 1000000 ); 
+                timeText << "Milliseconds since start time " << ( timer.getTicksNS() / 1000000 ) << ", wheel seconds " << wheelSeconds; 
                 SDL_Color textColor{ 0x00, 0x00, 0x00, 0xFF };
                 gTimeTextTexture.loadFromRenderedText( timeText.str().c_str(), textColor );
 
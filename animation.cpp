@@ -9,6 +9,25 @@
 #include <SDL3_ttf/SDL_ttf.h>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <deque>
+#include <list>
+
+//Vector blend kernels are built for x86 and picked at runtime
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LAZYFOO_X86_SIMD 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define LAZYFOO_TARGET_SSE2 __attribute__(( target( "sse2" ) ))
+#define LAZYFOO_TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+#else
+#define LAZYFOO_TARGET_SSE2
+#define LAZYFOO_TARGET_AVX2
+#endif
+#endif
 
 /* Constants */
 //Screen dimension constants
@@ -16,8 +35,14 @@ constexpr int kScreenWidth{ 640 };
 constexpr int kScreenHeight{ 480 };
 constexpr int kScreenFps{ 60 };
 
+//Frames to run in headless mode when no count is given
+constexpr int kDefaultBenchmarkFrames{ 1000 };
+
 
 /* Function Prototypes */
+//Reads headless options from the command line and environment
+void parseArguments( int argc, char* args[] );
+
 //Starts up SDL and creates window
 bool init();
 
@@ -27,6 +52,48 @@ bool loadMedia();
 //Frees media and shuts down SDL
 void close();
 
+//Clears the screen through the active backend
+void renderClear( Uint8 r, Uint8 g, Uint8 b, Uint8 a );
+
+//Shows the finished frame through the active backend
+void renderPresent();
+
+//Sends draws back to the screen after LTexture::setAsRenderTarget
+void resetRenderTarget();
+
+//Reads the visible area draws are culled against from the current viewport and clip rect
+void updateCullRect();
+
+//Checks if a draw's conservative bounds miss the visible area
+bool isOffscreen( const SDL_FRect& dstRect, double degrees, const SDL_FPoint* center );
+
+//Multiplies two 8 bit channels and divides by 255 with SDL's blitter rounding
+Uint32 mulDiv255( Uint32 a, Uint32 b );
+
+//Modulates and blends a span of ARGB8888 pixels onto the destination with the selected kernel
+void blendSpan( Uint32* dst, const Uint32* src, int count, SDL_Color colorMod, SDL_BlendMode blendMode );
+
+//Per pixel blend kernel that handles every blend mode
+void blendSpanScalar( Uint32* dst, const Uint32* src, int count, SDL_Color colorMod, SDL_BlendMode blendMode );
+
+#if defined(LAZYFOO_X86_SIMD)
+//Vector blend kernels for blend, add and multiply
+void blendSpanSSE2( Uint32* dst, const Uint32* src, int count, SDL_Color colorMod, SDL_BlendMode blendMode );
+void blendSpanAVX2( Uint32* dst, const Uint32* src, int count, SDL_Color colorMod, SDL_BlendMode blendMode );
+#endif
+
+//Picks the fastest blend kernel the CPU supports
+void selectBlendKernel();
+
+//Checks every blend kernel against SDL's surface blitter
+bool validateBlendKernels();
+
+//Times every blend kernel per megapixel
+void runBlendBenchmark();
+
+//Times the tiled rasterizer from one thread up to every core
+void runTileScalingBenchmark();
+
 class Dot
 {
     public:
@@ -57,11 +124,80 @@ class Dot
         int mVelX, mVelY;
 };
 
-class LTimer
+class LClock
+{
+    public:
+        //Cleans up the clock
+        virtual ~LClock() = default;
+
+        //Gets the clock's time
+        virtual Uint64 getTicksNS() = 0;
+
+        //Waits for an amount of the clock's time
+        virtual void delayNS( Uint64 ns ) = 0;
+
+        //Checks if time only moves when asked to, busy waiting on these never ends
+        virtual bool isVirtual();
+};
+
+class LRealClock : public LClock
+{
+    public:
+        //Wall clock time since SDL started
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+};
+
+class LScaledClock : public LClock
+{
+    public:
+        //Initializes variables
+        LScaledClock( LClock& source, double scale );
+
+        //Changes speed without making time jump
+        void setScale( double scale );
+        double getScale();
+
+        //Source time multiplied by the scale
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+
+    private:
+        //Clock being scaled
+        LClock& mSource;
+
+        //Time multiplier
+        double mScale;
+
+        //Source and scaled time when the scale last changed
+        Uint64 mSourceAnchor;
+        Uint64 mTicksAnchor;
+};
+
+class LSteppedClock : public LClock
 {
     public:
         //Initializes variables
-        LTimer();
+        LSteppedClock();
+
+        //Moves time forward
+        void step( Uint64 ns );
+
+        //Time only moves when stepped or delayed, delays return immediately
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+        bool isVirtual() override;
+
+    private:
+        //Current time
+        Uint64 mTicks;
+};
+
+class LTimer
+{
+    public:
+        //Initializes variables, timers read the global clock unless given their own
+        LTimer( LClock* clock = nullptr );
 
         //The various clock actions
         void start();
@@ -76,7 +212,13 @@ class LTimer
         bool isStarted();
         bool isPaused();
 
+        //Gets the clock the timer reads
+        LClock* getClock();
+
     private:
+        //Clock this timer always reads, null to follow the global clock
+        LClock* mClock;
+
         //The clock time when the timer started
         Uint64 mStartTicks;
 
@@ -88,6 +230,107 @@ class LTimer
         bool mStarted;
 };
 
+class LFramePacer
+{
+    public:
+        //How waits reach the deadline
+        enum class ePacing
+        {
+            Sleep,
+            Hybrid
+        };
+
+        //Number of recent frames the jitter statistics cover
+        static constexpr int kJitterSamples = 600;
+
+        //Limits for the calibrated time left to spin after sleeping
+        static constexpr Uint64 kMinSpinMarginNS = 200000;
+        static constexpr Uint64 kMaxSpinMarginNS = 4000000;
+
+        //Initializes variables
+        LFramePacer();
+
+        //Starts pacing with the first deadline one period from now
+        void start( Uint64 periodNs, ePacing pacing = ePacing::Hybrid );
+
+        //Waits for the current deadline and sets the next one
+        void wait();
+
+        //Switches how waits reach the deadline and clears statistics
+        void setPacing( ePacing pacing );
+        ePacing getPacing();
+
+        //Gets how far wakeups landed from their deadlines
+        Uint64 getMeanErrorNS();
+        Uint64 getP99ErrorNS();
+        int getSampleCount();
+
+        //Logs jitter statistics
+        void report();
+
+        //Starts a new statistics window
+        void clearStatistics();
+
+    private:
+        //Stores the wakeup error for a frame
+        void addSample( Uint64 errorNs );
+
+        //Clock deadlines are measured on
+        LTimer mClock;
+
+        //Frame period and the absolute time of the next deadline
+        Uint64 mPeriodNs;
+        Uint64 mDeadlineNs;
+
+        //Time before the deadline when sleeping stops, grows with observed oversleep
+        Uint64 mSpinMarginNs;
+
+        //How waits reach the deadline
+        ePacing mPacing;
+
+        //Recent wakeup errors
+        Uint64 mErrors[ kJitterSamples ];
+        int mErrorCount;
+        int mNextError;
+};
+
+//Draws sent to the backend and skipped by culling
+struct LRenderCounters
+{
+    int drawn;
+    int culled;
+};
+
+class LFrameBenchmark
+{
+    public:
+        //Initializes variables
+        LFrameBenchmark();
+
+        //Starts a new run
+        void start();
+
+        //Records the duration and draw counts of one frame
+        void addFrame( Uint64 frameNs, const LRenderCounters& counters );
+
+        //Gets the number of recorded frames
+        int getFrameCount();
+
+        //Prints throughput and per frame timing
+        void report();
+
+    private:
+        //Duration of every recorded frame
+        std::vector<Uint64> mFrameTimes;
+
+        //Draw counts over the run
+        Uint64 mDrawnTotal;
+        Uint64 mCulledTotal;
+
+        //Time since the run started
+        LTimer mRunTimer;
+};
+
 
 class LButton
 {
@@ -128,6 +371,14 @@ class LButton
 
 
 /* Class Prototypes */
+//Blend span implementations
+enum class eBlendKernel
+{
+    Scalar = 0,
+    SSE2 = 1,
+    AVX2 = 2
+};
+
 class LTexture
 {
 public:
@@ -140,17 +391,23 @@ public:
     //Cleans up texture variables
     ~LTexture();
 
-    //Loads texture from disk
-    bool loadFromFile( std::string path );
+    //Loads texture from disk, optionally premultiplying color by alpha
+    bool loadFromFile( std::string path, bool premultiplyAlpha = false );
 
     #if defined(SDL_TTF_MAJOR_VERSION)
     //Creates texture from text
     bool loadFromRenderedText( std::string textureText, SDL_Color textColor );
     #endif
 
+    //Creates a blank ARGB8888 texture, drawable into when it is a render target
+    bool createBlank( int width, int height, SDL_TextureAccess access = SDL_TEXTUREACCESS_TARGET );
+
     //Cleans up texture
     void destroy();
 
+    //Sends following draws into this texture
+    void setAsRenderTarget();
+
      //Sets color modulation
     void setColor( Uint8 r, Uint8 g, Uint8 b);
 
@@ -169,12 +426,438 @@ public:
     bool isLoaded();
 
 private:
+    //Keeps an ARGB8888 copy of the pixels when the tiled backend is on
+    void keepPixels( SDL_Surface* surface );
+
+    //Gets the color modulation to draw with, scaled by alpha for premultiplied pixels
+    SDL_Color getDrawColorMod();
+
+    //Sends color and alpha modulation to SDL
+    void applyColorMod();
+
+    //Identifies the texture in render logs
+    Uint32 mId;
+
     //Contains texture data
     SDL_Texture* mTexture;
 
+    //CPU side pixels for the tiled backend
+    SDL_Surface* mPixels;
+
     //Texture dimensions
     int mWidth;
     int mHeight;
+
+    //Modulation and blending state mirrored for the tiled backend
+    SDL_Color mColorMod;
+    SDL_BlendMode mBlendMode;
+
+    //Whether pixels were premultiplied by alpha at load
+    bool mPremultiplied;
+};
+
+//A recorded LTexture::render call for the tiled backend
+struct LDrawCommand
+{
+    //Source pixels in ARGB8888
+    SDL_Surface* source;
+
+    //Source and destination rectangles in pixels
+    SDL_Rect srcRect;
+    SDL_FRect dstRect;
+
+    //Rotation and flipping
+    double degrees;
+    SDL_FPoint center;
+    SDL_FlipMode flipMode;
+
+    //Color/alpha modulation and blend mode
+    SDL_Color colorMod;
+    SDL_BlendMode blendMode;
+};
+
+class LTileRenderer
+{
+    public:
+        //Tile dimensions in pixels
+        static constexpr int kTileSize = 64;
+
+        //Initializes variables
+        LTileRenderer();
+
+        //Shuts down workers
+        ~LTileRenderer();
+
+        //Creates the framebuffer, streaming texture and worker threads
+        bool init( int width, int height, int threadCount );
+
+        //Stops workers and frees the framebuffer
+        void destroy();
+
+        //Checks if draws should be recorded instead of sent to SDL
+        bool isEnabled();
+
+        //Gets the number of threads rasterizing tiles (including the caller)
+        int getThreadCount();
+
+        //Gets the last flushed framebuffer in ARGB8888
+        const Uint32* getPixels();
+        int getWidth();
+        int getHeight();
+
+        //Starts a new frame filled with the given color
+        void clear( Uint8 r, Uint8 g, Uint8 b, Uint8 a );
+
+        //Records a draw command
+        void draw( const LDrawCommand& command );
+
+        //Rasterizes all recorded commands across the worker threads
+        void flush();
+
+        //Flushes and copies the framebuffer to the window renderer
+        void present();
+
+    private:
+        //Worker thread entry point
+        static int workerMain( void* data );
+
+        //Rasterizes tiles until none are left
+        void runTiles();
+
+        //Rasterizes every command binned into one tile
+        void rasterizeTile( int tile );
+
+        //Rasterizes the part of a command that covers a tile
+        void rasterizeCommand( const LDrawCommand& command, const SDL_Rect& tileRect );
+
+        //Gets the destination pixel bounds of a command
+        SDL_Rect getCommandBounds( const LDrawCommand& command );
+
+        //Framebuffer in ARGB8888
+        std::vector<Uint32> mPixels;
+        int mWidth;
+        int mHeight;
+
+        //Texture the framebuffer is streamed through
+        SDL_Texture* mTexture;
+
+        //Commands recorded this frame and the command indices touching each tile
+        std::vector<LDrawCommand> mCommands;
+        std::vector<std::vector<int>> mTileBins;
+        int mTilesX;
+        int mTilesY;
+
+        //Color the frame is cleared to
+        Uint32 mClearColor;
+
+        //Worker threads and their synchronization
+        std::vector<SDL_Thread*> mWorkers;
+        SDL_Mutex* mMutex;
+        SDL_Condition* mWorkReady;
+        SDL_Condition* mWorkDone;
+        SDL_AtomicInt mNextTile;
+        int mGeneration;
+        int mBusyWorkers;
+        bool mQuit;
+};
+
+//Operations stored in a render log
+enum class eRenderOp : Uint8
+{
+    LoadFile = 1,
+    LoadText = 2,
+    Destroy = 3,
+    SetColor = 4,
+    SetAlpha = 5,
+    SetBlending = 6,
+    Render = 7,
+    Clear = 8,
+    Present = 9,
+    CreateBlank = 10,
+    SetTarget = 11
+};
+
+class LRenderRecorder
+{
+    public:
+        //Log file identification
+        static constexpr Uint32 kMagic = 0x4352464C;
+        static constexpr Uint32 kVersion = 2;
+
+        //Initializes variables
+        LRenderRecorder();
+
+        //Flushes and closes the log
+        ~LRenderRecorder();
+
+        //Opens a log file and writes its header
+        bool open( std::string path );
+
+        //Flushes and closes the log
+        void close();
+
+        //Checks if calls are being recorded
+        bool isRecording();
+
+        //Records texture lifetime
+        void recordLoadFile( Uint32 textureId, const std::string& path, bool premultiplyAlpha );
+        void recordLoadText( Uint32 textureId, const std::string& text, SDL_Color color );
+        void recordCreateBlank( Uint32 textureId, int width, int height, SDL_TextureAccess access );
+        void recordDestroy( Uint32 textureId );
+
+        //Records texture state
+        void recordSetColor( Uint32 textureId, Uint8 r, Uint8 g, Uint8 b );
+        void recordSetAlpha( Uint32 textureId, Uint8 alpha );
+        void recordSetBlending( Uint32 textureId, SDL_BlendMode blendMode );
+
+        //Records a draw with LTexture::render's arguments
+        void recordRender( Uint32 textureId, float x, float y, const SDL_FRect* clip, float width, float height, double degrees, const SDL_FPoint* center, SDL_FlipMode flipMode );
+
+        //Records frame boundaries and render target switches, 0 being the screen
+        void recordClear( Uint8 r, Uint8 g, Uint8 b, Uint8 a );
+        void recordPresent();
+        void recordSetTarget( Uint32 textureId );
+
+    private:
+        //Appends raw bytes of a value
+        template<typename T>
+        void write( const T& value );
+
+        //Appends a length prefixed string
+        void writeString( const std::string& text );
+
+        //Writes buffered bytes to the file
+        void flush();
+
+        //Log file
+        SDL_IOStream* mFile;
+
+        //Bytes waiting to be written
+        std::vector<Uint8> mBuffer;
+};
+
+class LRenderReplayer
+{
+    public:
+        //Initializes variables
+        LRenderReplayer();
+
+        //Reads a whole log into memory
+        bool load( std::string path );
+
+        //Executes the log as fast as possible and reports frame timing
+        bool replay();
+
+    private:
+        //Reads raw bytes of a value, false at end of log
+        template<typename T>
+        bool read( T& value );
+
+        //Reads a length prefixed string
+        bool readString( std::string& text );
+
+        //Gets the replay texture for a recorded id
+        LTexture& getTexture( Uint32 textureId );
+
+        //The log contents and read position
+        std::vector<Uint8> mLog;
+        size_t mPosition;
+
+        //Textures created by the log keyed by recorded id
+        std::unordered_map<Uint32, std::unique_ptr<LTexture>> mTextures;
+};
+
+class LFrameCapture
+{
+    public:
+        //Frames that can wait for encoding before new ones are dropped
+        static constexpr int kDefaultPoolSize = 8;
+
+        //Initializes variables
+        LFrameCapture();
+
+        //Stops the encoders
+        ~LFrameCapture();
+
+        //Starts encoder threads writing frames into a directory as PNG or raw ARGB8888
+        bool start( std::string directory, bool rawOutput, int poolSize = kDefaultPoolSize, int workerCount = 2 );
+
+        //Writes the queued frames and stops the encoders
+        void stop();
+
+        //Checks if frames are being captured
+        bool isCapturing();
+
+        //Reads back the current frame, dropping it if every buffer is still waiting to be encoded
+        void captureFrame();
+
+    private:
+        //A pooled frame waiting for or being encoded, readback is converted into pixels by the encoder when set
+        struct LCaptureBuffer
+        {
+            std::vector<Uint32> pixels;
+            int width;
+            int height;
+            Uint64 frameIndex;
+            SDL_Surface* readback;
+        };
+
+        //Encoder thread entry point
+        static int workerMain( void* data );
+
+        //Writes one buffer to disk
+        void encode( LCaptureBuffer& buffer );
+
+        //Output settings
+        std::string mDirectory;
+        bool mRawOutput;
+
+        //Buffer pool, indices of free buffers and of buffers waiting to be encoded
+        std::vector<LCaptureBuffer> mBuffers;
+        std::vector<int> mFreeBuffers;
+        std::deque<int> mPendingBuffers;
+
+        //Encoder threads and their synchronization
+        std::vector<SDL_Thread*> mWorkers;
+        SDL_Mutex* mMutex;
+        SDL_Condition* mWorkReady;
+        bool mQuit;
+
+        //Frame counters
+        Uint64 mFrameIndex;
+        Uint64 mWrittenFrames;
+        Uint64 mDroppedFrames;
+};
+
+class LTilemap
+{
+    public:
+        //Tiles along each side of a chunk
+        static constexpr int kChunkTiles = 16;
+
+        //Chunk textures kept before the least recently drawn is reused
+        static constexpr int kDefaultMaxChunks = 24;
+
+        //Initializes variables
+        LTilemap();
+
+        //Frees chunk textures
+        ~LTilemap();
+
+        //Sets up an empty map drawn from clips of a tile sheet
+        bool init( LTexture* tileSheet, const std::vector<SDL_FRect>& tileClips, int tileWidth, int tileHeight, int columns, int rows, int maxCachedChunks = kDefaultMaxChunks );
+
+        //Frees the map and its chunk textures
+        void destroy();
+
+        //Sets a tile, marking its chunk to be redrawn
+        void setTile( int column, int row, Uint8 tile );
+
+        //Gets a tile
+        Uint8 getTile( int column, int row );
+
+        //Draws the chunks in view with the camera's top left at the given map position
+        void render( float cameraX, float cameraY );
+
+        //Gets map dimensions in pixels
+        int getPixelWidth();
+        int getPixelHeight();
+
+        //Gets the number of chunks that currently have a texture
+        int getCachedChunkCount();
+
+    private:
+        //A chunk's cached texture and where it sits in the LRU list
+        struct LChunk
+        {
+            std::unique_ptr<LTexture> texture;
+            std::list<int>::iterator lruPosition;
+            bool dirty;
+        };
+
+        //Gets an up to date texture for a chunk, reusing the least recently drawn chunk's if the cache is full
+        LTexture* acquireChunk( int chunk );
+
+        //Draws a chunk's tiles into its texture
+        void buildChunk( int chunk );
+
+        //Draws a chunk's tiles straight to the screen
+        void renderChunkTiles( int chunk, float screenX, float screenY );
+
+        //Tile source
+        LTexture* mTileSheet;
+        std::vector<SDL_FRect> mTileClips;
+
+        //Tile and map dimensions
+        int mTileWidth;
+        int mTileHeight;
+        int mColumns;
+        int mRows;
+        int mChunkColumns;
+        int mChunkRows;
+
+        //Tile indices row by row
+        std::vector<Uint8> mTiles;
+
+        //Chunk cache with the most recently drawn chunk at the front
+        std::vector<LChunk> mChunks;
+        std::list<int> mLru;
+        int mMaxCachedChunks;
+};
+
+class LDynamicResolution
+{
+    public:
+        //Scale limits and how far one adjustment moves
+        static constexpr float kMinScale = 0.5f;
+        static constexpr float kScaleStep = 0.1f;
+
+        //Budget fractions that trigger lowering and raising the scale
+        static constexpr double kLowerThreshold = 0.90;
+        static constexpr double kRaiseThreshold = 0.60;
+
+        //Consecutive frames needed before lowering and raising, raising waits longer to avoid oscillating
+        static constexpr int kLowerFrames = 5;
+        static constexpr int kRaiseFrames = 60;
+
+        //Initializes variables
+        LDynamicResolution();
+
+        //Creates the full size offscreen target
+        bool init( Uint64 frameBudgetNs );
+
+        //Frees the offscreen target
+        void destroy();
+
+        //Checks if frames are drawn offscreen
+        bool isEnabled();
+
+        //Gets the current resolution scale
+        float getScale();
+
+        //Starts drawing the scene into the scaled part of the offscreen target
+        void beginFrame();
+
+        //Upscales the scene to the window
+        void endFrame();
+
+        //Adjusts the scale from the time the frame took to build
+        void update( Uint64 frameNs );
+
+    private:
+        //Offscreen target sized for scale 1
+        LTexture mTarget;
+
+        //Current scale and time allowed per frame
+        float mScale;
+        Uint64 mFrameBudgetNs;
+
+        //Smoothed frame time
+        double mAverageFrameNs;
+
+        //Consecutive frames over and under the thresholds
+        int mSlowFrames;
+        int mFastFrames;
 };
 
 
@@ -189,9 +872,88 @@ SDL_Renderer* gRenderer{ nullptr };
 //Global font
 TTF_Font* gFont{ nullptr };
 
+//Headless benchmark mode
+bool gHeadless{ false };
+
+//Wall clock, used directly by anything measuring real cost
+LRealClock gRealClock;
+
+//Clock timers and pacers read, picked with --clock real|scaled|stepped and --time-scale
+LClock* gClock{ &gRealClock };
+std::unique_ptr<LClock> gVirtualClock;
+const char* gClockName{ nullptr };
+double gTimeScale{ 1.0 };
+
+//Frames to run before quitting in headless mode
+int gBenchmarkFrames{ kDefaultBenchmarkFrames };
+
+//Tiled software rasterizer used instead of SDL's renderer when enabled
+LTileRenderer gTileRenderer;
+
+//Threads for the tiled rasterizer, 0 leaves it off
+int gTileThreads{ 0 };
+
+//Run the tiled thread scaling benchmark instead of the scene
+bool gTileBenchmark{ false };
+
+//Visible area in render coordinates that draws are culled against
+SDL_FRect gCullRect{ 0.f, 0.f, static_cast<float>( kScreenWidth ), static_cast<float>( kScreenHeight ) };
+
+//Draw counts for the frame being built and the last presented frame
+LRenderCounters gRenderCounters{ 0, 0 };
+LRenderCounters gLastFrameCounters{ 0, 0 };
+
+//Id handed to the next texture created
+Uint32 gNextTextureId{ 1 };
+
+//Texture draws go to, nullptr for the screen
+LTexture* gRenderTarget{ nullptr };
+
+//Render call log written with --record
+LRenderRecorder gRenderRecorder;
+
+//Log paths to record to and replay from
+const char* gRecordPath{ nullptr };
+const char* gReplayPath{ nullptr };
+
+//Presented frames written to disk with --capture
+LFrameCapture gFrameCapture;
+
+//Directory and format for captured frames
+const char* gCapturePath{ nullptr };
+bool gCaptureRaw{ false };
+
+//Kernel used by blendSpan
+eBlendKernel gBlendKernel{ eBlendKernel::Scalar };
+
+//Blend mode for premultiplied textures: color + dst * ( 1 - srcA )
+SDL_BlendMode gPremultipliedBlendMode{ SDL_BLENDMODE_BLEND_PREMULTIPLIED };
+
+//Load scene sprites with premultiplied alpha
+bool gPremultiplyAlpha{ false };
+
+//Forced kernel name from the command line
+const char* gBlendKernelName{ nullptr };
+
+//Run the blend kernel validation or benchmark instead of the scene
+bool gBlendValidate{ false };
+bool gBlendBenchmark{ false };
+
 //The directional images
 LTexture gSpriteSheetTexture;
 
+//Tile sheet and scrolling map drawn with --tilemap
+LTexture gDotsTexture;
+LTilemap gTilemap;
+bool gTilemapScene{ false };
+
+//Offscreen scene scaling to hold the frame budget, enabled with --dynamic-resolution
+LDynamicResolution gDynamicResolution;
+bool gDynamicResolutionEnabled{ false };
+
+//How windowed frames wait for their deadline, set with --pacing sleep|hybrid
+LFramePacer::ePacing gFramePacing{ LFramePacer::ePacing::Hybrid };
+
 
 
 /* Class Implementations */
@@ -263,8 +1025,91 @@ void Dot::render()
 }
 
 
-//LTimer Implementation
-LTimer::LTimer():
+//LClock Implementation
+bool LClock::isVirtual()
+{
+    return false;
+}
+
+
+//LRealClock Implementation
+Uint64 LRealClock::getTicksNS()
+{
+    return SDL_GetTicksNS();
+}
+
+void LRealClock::delayNS( Uint64 ns )
+{
+    SDL_DelayNS( ns );
+}
+
+
+//LScaledClock Implementation
+LScaledClock::LScaledClock( LClock& source, double scale ):
+    mSource( source ),
+    mScale{ scale },
+    mSourceAnchor{ source.getTicksNS() },
+    mTicksAnchor{ 0 }
+{
+
+}
+
+void LScaledClock::setScale( double scale )
+{
+    //Keep the time so far and scale from here on
+    mTicksAnchor = getTicksNS();
+    mSourceAnchor = mSource.getTicksNS();
+    mScale = scale;
+}
+
+double LScaledClock::getScale()
+{
+    return mScale;
+}
+
+Uint64 LScaledClock::getTicksNS()
+{
+    return mTicksAnchor + static_cast<Uint64>( ( mSource.getTicksNS() - mSourceAnchor ) * mScale );
+}
+
+void LScaledClock::delayNS( Uint64 ns )
+{
+    mSource.delayNS( static_cast<Uint64>( ns / mScale ) );
+}
+
+
+//LSteppedClock Implementation
+LSteppedClock::LSteppedClock():
+    mTicks{ 0 }
+{
+
+}
+
+void LSteppedClock::step( Uint64 ns )
+{
+    mTicks += ns;
+}
+
+Uint64 LSteppedClock::getTicksNS()
+{
+    return mTicks;
+}
+
+void LSteppedClock::delayNS( Uint64 ns )
+{
+    //Nothing to wait for, the wait is over as soon as time says so
+    mTicks += ns;
+}
+
+bool LSteppedClock::isVirtual()
+{
+    return true;
+}
+
+
+//LTimer Implementation
+LTimer::LTimer( LClock* clock ):
+    mClock{ clock },
     mStartTicks{ 0 },
     mPausedTicks{ 0 },
 
@@ -283,7 +1128,7 @@ void LTimer::start()
     mPaused = false;
 
     //Get the current clock time
-    mStartTicks = SDL_GetTicksNS();
+    mStartTicks = getClock()->getTicksNS();
     mPausedTicks = 0;
 }
 
@@ -309,7 +1154,7 @@ void LTimer::pause()
         mPaused = true;
 
         //Calculate the paused ticks
-        mPausedTicks = SDL_GetTicksNS() - mStartTicks;
+        mPausedTicks = getClock()->getTicksNS() - mStartTicks;
         mStartTicks = 0;
     }
 }
@@ -323,7 +1168,7 @@ void LTimer::unpause()
         mPaused = false;
 
         //Reset the starting ticks
-        mStartTicks = SDL_GetTicksNS() - mPausedTicks;
+        mStartTicks = getClock()->getTicksNS() - mPausedTicks;
 
         //Reset the paused ticks
         mPausedTicks = 0;
@@ -347,7 +1192,7 @@ Uint64 LTimer::getTicksNS()
         else
         {
             //Return the current time minus the start time
-            time = SDL_GetTicksNS() - mStartTicks;
+            time = getClock()->getTicksNS() - mStartTicks;
         }
     }
 
@@ -364,6 +1209,223 @@ bool LTimer::isStarted()
     return mStarted;
 }
 
+LClock* LTimer::getClock()
+{
+    return mClock != nullptr ? mClock : gClock;
+}
+
+//LFramePacer Implementation
+LFramePacer::LFramePacer():
+    mPeriodNs{ 0 },
+    mDeadlineNs{ 0 },
+    mSpinMarginNs{ 2000000 },
+    mPacing{ ePacing::Hybrid },
+    mErrors{},
+    mErrorCount{ 0 },
+    mNextError{ 0 }
+{
+
+}
+
+void LFramePacer::start( Uint64 periodNs, ePacing pacing )
+{
+    //Deadlines are absolute so late frames don't push later ones back
+    mPeriodNs = periodNs;
+    mDeadlineNs = periodNs;
+    mPacing = pacing;
+    clearStatistics();
+    mClock.start();
+}
+
+void LFramePacer::wait()
+{
+    Uint64 now{ mClock.getTicksNS() };
+    if( now < mDeadlineNs )
+    {
+        //Sleep through most of the wait, hybrid pacing stops early enough to absorb oversleep
+        Uint64 margin{ mPacing == ePacing::Hybrid ? mSpinMarginNs : 0 };
+        if( mDeadlineNs - now > margin )
+        {
+            Uint64 requestedNs{ mDeadlineNs - now - margin };
+            mClock.getClock()->delayNS( requestedNs );
+            Uint64 woke{ mClock.getTicksNS() };
+
+            //Track oversleep, jump up to a new worst case and slowly come back down
+            Uint64 oversleepNs{ woke - now > requestedNs ? woke - now - requestedNs : 0 };
+            if( oversleepNs > mSpinMarginNs )
+            {
+                mSpinMarginNs = oversleepNs + oversleepNs / 4;
+            }
+            else
+            {
+                mSpinMarginNs -= ( mSpinMarginNs - oversleepNs ) / 64;
+            }
+            mSpinMarginNs = SDL_clamp( mSpinMarginNs, kMinSpinMarginNS, kMaxSpinMarginNS );
+            now = woke;
+        }
+
+        //Spin out the rest, virtual clocks only move when waited on
+        if( mClock.getClock()->isVirtual() )
+        {
+            mClock.getClock()->delayNS( mDeadlineNs - now );
+            now = mClock.getTicksNS();
+        }
+        while( now < mDeadlineNs )
+        {
+            SDL_CPUPauseInstruction();
+            now = mClock.getTicksNS();
+        }
+    }
+
+    addSample( now - mDeadlineNs );
+
+    //Next deadline, resync instead of rushing frames to catch up if more than a frame behind
+    mDeadlineNs += mPeriodNs;
+    if( now >= mDeadlineNs )
+    {
+        mDeadlineNs = now + mPeriodNs;
+    }
+}
+
+void LFramePacer::setPacing( ePacing pacing )
+{
+    mPacing = pacing;
+    clearStatistics();
+}
+
+LFramePacer::ePacing LFramePacer::getPacing()
+{
+    return mPacing;
+}
+
+Uint64 LFramePacer::getMeanErrorNS()
+{
+    if( mErrorCount == 0 )
+    {
+        return 0;
+    }
+
+    Uint64 sum{ 0 };
+    for( int i = 0; i < mErrorCount; ++i )
+    {
+        sum += mErrors[ i ];
+    }
+    return sum / mErrorCount;
+}
+
+Uint64 LFramePacer::getP99ErrorNS()
+{
+    if( mErrorCount == 0 )
+    {
+        return 0;
+    }
+
+    //Select on a copy so the ring keeps its order
+    Uint64 sorted[ kJitterSamples ];
+    std::copy( mErrors, mErrors + mErrorCount, sorted );
+    int index{ ( mErrorCount - 1 ) * 99 / 100 };
+    std::nth_element( sorted, sorted + index, sorted + mErrorCount );
+    return sorted[ index ];
+}
+
+int LFramePacer::getSampleCount()
+{
+    return mErrorCount;
+}
+
+void LFramePacer::report()
+{
+    SDL_Log( "Frame pacer (%s): %d frames, wakeup error mean %.3f ms p99 %.3f ms, spin margin %.3f ms\n",
+        mPacing == ePacing::Hybrid ? "hybrid" : "sleep", mErrorCount,
+        getMeanErrorNS() / 1000000.0, getP99ErrorNS() / 1000000.0, mSpinMarginNs / 1000000.0 );
+}
+
+void LFramePacer::clearStatistics()
+{
+    mErrorCount = 0;
+    mNextError = 0;
+}
+
+void LFramePacer::addSample( Uint64 errorNs )
+{
+    mErrors[ mNextError ] = errorNs;
+    mNextError = ( mNextError + 1 ) % kJitterSamples;
+    if( mErrorCount < kJitterSamples )
+    {
+        ++mErrorCount;
+    }
+}
+
+
+//LFrameBenchmark Implementation
+LFrameBenchmark::LFrameBenchmark():
+    mDrawnTotal{ 0 },
+    mCulledTotal{ 0 },
+    mRunTimer{ &gRealClock }
+{
+
+}
+
+void LFrameBenchmark::start()
+{
+    //Clear old frames and start timing the run
+    mFrameTimes.clear();
+    mDrawnTotal = 0;
+    mCulledTotal = 0;
+    mFrameTimes.reserve( gBenchmarkFrames );
+    mRunTimer.start();
+}
+
+void LFrameBenchmark::addFrame( Uint64 frameNs, const LRenderCounters& counters )
+{
+    mFrameTimes.push_back( frameNs );
+    mDrawnTotal += counters.drawn;
+    mCulledTotal += counters.culled;
+}
+
+int LFrameBenchmark::getFrameCount()
+{
+    return static_cast<int>( mFrameTimes.size() );
+}
+
+void LFrameBenchmark::report()
+{
+    //Nothing to report
+    if( mFrameTimes.empty() )
+    {
+        SDL_Log( "Benchmark: no frames recorded\n" );
+        return;
+    }
+
+    //Sort a copy so percentiles can be read by index
+    std::vector<Uint64> sorted{ mFrameTimes };
+    std::sort( sorted.begin(), sorted.end() );
+
+    Uint64 totalFrameNs{ 0 };
+    for( Uint64 frameNs : sorted )
+    {
+        totalFrameNs += frameNs;
+    }
+
+    //Gets a percentile in milliseconds
+    auto percentileMs = [ &sorted ]( double percentile )
+    {
+        size_t index = static_cast<size_t>( percentile * static_cast<double>( sorted.size() - 1 ) );
+        return static_cast<double>( sorted[ index ] ) / 1000000.0;
+    };
+
+    double runSeconds{ static_cast<double>( mRunTimer.getTicksNS() ) / 1000000000.0 };
+    double meanMs{ static_cast<double>( totalFrameNs ) / static_cast<double>( sorted.size() ) / 1000000.0 };
+
+    SDL_Log( "Benchmark: %d frames in %.3f s (%.1f frames/s) on %s/%s\n",
+        getFrameCount(), runSeconds, static_cast<double>( sorted.size() ) / runSeconds,
+        SDL_GetCurrentVideoDriver(), SDL_GetRendererName( gRenderer ) );
+    SDL_Log( "Frame ms - min:%.3f mean:%.3f p50:%.3f p95:%.3f p99:%.3f max:%.3f\n",
+        percentileMs( 0.0 ), meanMs, percentileMs( 0.5 ), percentileMs( 0.95 ), percentileMs( 0.99 ), percentileMs( 1.0 ) );
+    SDL_Log( "Draws per frame - drawn:%.1f culled:%.1f\n",
+        static_cast<double>( mDrawnTotal ) / sorted.size(), static_cast<double>( mCulledTotal ) / sorted.size() );
+}
+
 //LButton Implementation
 LButton::LButton():
     mPosition{ 0.f, 0.f },
@@ -458,9 +1520,14 @@ void LButton::render()
 //LTexture Implementation
 LTexture::LTexture():
     //Initialize texture variables
+    mId{ gNextTextureId++ },
     mTexture{ nullptr },
+    mPixels{ nullptr },
     mWidth{ 0 },
-    mHeight{ 0 }
+    mHeight{ 0 },
+    mColorMod{ 0xFF, 0xFF, 0xFF, 0xFF },
+    mBlendMode{ SDL_BLENDMODE_BLEND },
+    mPremultiplied{ false }
 {
 
 }
@@ -471,7 +1538,7 @@ LTexture::~LTexture()
     destroy();
 }
 
-bool LTexture::loadFromFile( std::string path )
+bool LTexture::loadFromFile( std::string path, bool premultiplyAlpha )
 {
     //Clean up texture if it already exists
     destroy();
@@ -490,6 +1557,22 @@ bool LTexture::loadFromFile( std::string path )
         }
         else
         {
+            //Turn the color key into alpha and multiply it into the color channels
+            if( premultiplyAlpha )
+            {
+                if( SDL_Surface* premultipliedSurface = SDL_ConvertSurface( loadedSurface, SDL_PIXELFORMAT_ARGB8888 ); premultipliedSurface == nullptr || SDL_PremultiplySurfaceAlpha( premultipliedSurface, false ) == false )
+                {
+                    SDL_Log( "Unable to premultiply alpha! SDL error: %s\n", SDL_GetError() );
+                    SDL_DestroySurface( premultipliedSurface );
+                    premultiplyAlpha = false;
+                }
+                else
+                {
+                    SDL_DestroySurface( loadedSurface );
+                    loadedSurface = premultipliedSurface;
+                }
+            }
+
             //Create texture from surface
             if( mTexture = SDL_CreateTextureFromSurface( gRenderer, loadedSurface ); mTexture == nullptr )
             {
@@ -500,6 +1583,19 @@ bool LTexture::loadFromFile( std::string path )
                 //Get image dimensions
                 mWidth = loadedSurface->w;
                 mHeight = loadedSurface->h;
+
+                //Log the load before the blend mode it sets
+                if( gRenderRecorder.isRecording() )
+                {
+                    gRenderRecorder.recordLoadFile( mId, path, premultiplyAlpha );
+                }
+
+                //Premultiplied pixels need the matching blend mode
+                mPremultiplied = premultiplyAlpha;
+                setBlending( SDL_BLENDMODE_BLEND );
+
+                //Keep pixels for software rasterizing
+                keepPixels( loadedSurface );
             }
         }
         
@@ -527,17 +1623,93 @@ bool LTexture::isLoaded()
     return mTexture != nullptr;
 }
 
+bool LTexture::createBlank( int width, int height, SDL_TextureAccess access )
+{
+    //Clean up texture if it already exists
+    destroy();
+
+    //Create uninitialized texture
+    if( mTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888, access, width, height ); mTexture == nullptr )
+    {
+        SDL_Log( "Unable to create blank texture! SDL error: %s\n", SDL_GetError() );
+    }
+    else
+    {
+        mWidth = width;
+        mHeight = height;
+        setBlending( SDL_BLENDMODE_BLEND );
+
+        if( gRenderRecorder.isRecording() )
+        {
+            gRenderRecorder.recordCreateBlank( mId, width, height, access );
+        }
+    }
+
+    return mTexture != nullptr;
+}
+
+void LTexture::setAsRenderTarget()
+{
+    if( gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordSetTarget( mId );
+    }
+
+    //Draw into texture and cull against its size
+    SDL_SetRenderTarget( gRenderer, mTexture );
+    gRenderTarget = this;
+    updateCullRect();
+}
+
 void LTexture::destroy()
 {
+    //Log loaded textures going away
+    if( mTexture != nullptr && gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordDestroy( mId );
+    }
+
+    //SDL falls back to the screen when the target goes away
+    if( gRenderTarget == this )
+    {
+        gRenderTarget = nullptr;
+    }
+
     //Clean up texture
     SDL_DestroyTexture( mTexture );
     mTexture = nullptr;
+    SDL_DestroySurface( mPixels );
+    mPixels = nullptr;
     mWidth = 0;
     mHeight = 0;
+    mColorMod = SDL_Color{ 0xFF, 0xFF, 0xFF, 0xFF };
+    mBlendMode = SDL_BLENDMODE_BLEND;
+    mPremultiplied = false;
+}
+
+void LTexture::keepPixels( SDL_Surface* surface )
+{
+    //Match the texture's default blend mode
+    SDL_GetTextureBlendMode( mTexture, &mBlendMode );
+
+    //Color keyed pixels become transparent when converted to ARGB8888
+    if( gTileRenderer.isEnabled() )
+    {
+        if( mPixels = SDL_ConvertSurface( surface, SDL_PIXELFORMAT_ARGB8888 ); mPixels == nullptr )
+        {
+            SDL_Log( "Unable to copy pixels for tiled rendering! SDL error: %s\n", SDL_GetError() );
+        }
+    }
 }
 
 void LTexture::render( float x, float y, SDL_FRect* clip, float width, float height, double degrees, SDL_FPoint* center, SDL_FlipMode flipMode )
 {
+    //Log the call as made so replay repeats culling too
+    if( gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordRender( mId, x, y, clip, width, height, degrees, center, flipMode );
+    }
+
     //Set texture position
     SDL_FRect dstRect{ x, y, static_cast<float>( mWidth ), static_cast<float>( mHeight ) };
 
@@ -558,23 +1730,109 @@ void LTexture::render( float x, float y, SDL_FRect* clip, float width, float hei
         dstRect.h = height;
     }
 
+    //Skip draws that can't touch the screen
+    if( isOffscreen( dstRect, degrees, center ) )
+    {
+        gRenderCounters.culled++;
+        return;
+    }
+    gRenderCounters.drawn++;
+
+    //Record for the tiled backend
+    if( gTileRenderer.isEnabled() && mPixels != nullptr )
+    {
+        LDrawCommand command;
+        command.source = mPixels;
+        command.srcRect = SDL_Rect{ 0, 0, mWidth, mHeight };
+        if( clip != nullptr )
+        {
+            command.srcRect = SDL_Rect{ static_cast<int>( clip->x ), static_cast<int>( clip->y ), static_cast<int>( clip->w ), static_cast<int>( clip->h ) };
+        }
+        command.dstRect = dstRect;
+        command.degrees = degrees;
+        command.center = center != nullptr ? *center : SDL_FPoint{ dstRect.w / 2.f, dstRect.h / 2.f };
+        command.flipMode = flipMode;
+        command.colorMod = getDrawColorMod();
+        command.blendMode = mBlendMode == gPremultipliedBlendMode ? SDL_BLENDMODE_BLEND_PREMULTIPLIED : mBlendMode;
+        gTileRenderer.draw( command );
+        return;
+    }
+
     //Render texture
     SDL_RenderTextureRotated( gRenderer, mTexture, clip, &dstRect, degrees, center, flipMode );
 }
 
 void LTexture::setColor( Uint8 r, Uint8 g, Uint8 b )
 {
-    SDL_SetTextureColorMod( mTexture, r, g, b );
+    if( gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordSetColor( mId, r, g, b );
+    }
+
+    mColorMod.r = r;
+    mColorMod.g = g;
+    mColorMod.b = b;
+    applyColorMod();
 }
 
 void LTexture::setAlpha( Uint8 alpha )
 {
-    SDL_SetTextureAlphaMod( mTexture, alpha );
+    if( gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordSetAlpha( mId, alpha );
+    }
+
+    mColorMod.a = alpha;
+    applyColorMod();
 }
 
 void LTexture::setBlending( SDL_BlendMode blendMode )
 {
-    SDL_SetTextureBlendMode( mTexture, blendMode );
+    if( gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordSetBlending( mId, blendMode );
+    }
+
+    //Premultiplied pixels blend and add without weighting by alpha again
+    if( mPremultiplied && blendMode == SDL_BLENDMODE_BLEND )
+    {
+        blendMode = gPremultipliedBlendMode;
+    }
+    else if( mPremultiplied && blendMode == SDL_BLENDMODE_ADD )
+    {
+        blendMode = SDL_BLENDMODE_ADD_PREMULTIPLIED;
+    }
+
+    //Fall back to the built in premultiplied mode if the renderer rejects the custom one
+    if( SDL_SetTextureBlendMode( mTexture, blendMode ) == false && blendMode == gPremultipliedBlendMode )
+    {
+        blendMode = SDL_BLENDMODE_BLEND_PREMULTIPLIED;
+        SDL_SetTextureBlendMode( mTexture, blendMode );
+    }
+    mBlendMode = blendMode;
+}
+
+SDL_Color LTexture::getDrawColorMod()
+{
+    //Straight alpha pixels modulate as given
+    SDL_Color colorMod{ mColorMod };
+
+    //Premultiplied color has to fade with alpha to look the same
+    if( mPremultiplied && colorMod.a != 0xFF )
+    {
+        colorMod.r = static_cast<Uint8>( mulDiv255( colorMod.r, colorMod.a ) );
+        colorMod.g = static_cast<Uint8>( mulDiv255( colorMod.g, colorMod.a ) );
+        colorMod.b = static_cast<Uint8>( mulDiv255( colorMod.b, colorMod.a ) );
+    }
+
+    return colorMod;
+}
+
+void LTexture::applyColorMod()
+{
+    SDL_Color colorMod{ getDrawColorMod() };
+    SDL_SetTextureColorMod( mTexture, colorMod.r, colorMod.g, colorMod.b );
+    SDL_SetTextureAlphaMod( mTexture, colorMod.a );
 }
 
 #if defined(SDL_TTF_MAJOR_VERSION)
@@ -599,6 +1857,15 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
         {
             mWidth = textSurface->w;
             mHeight = textSurface->h;
+
+            //Keep pixels for software rasterizing
+            keepPixels( textSurface );
+
+            //Log the load
+            if( gRenderRecorder.isRecording() )
+            {
+                gRenderRecorder.recordLoadText( mId, textureText, textColor );
+            }
         }
 
         //Free temp surface
@@ -610,105 +1877,2349 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 }
 #endif
 
+//LTileRenderer Implementation
+LTileRenderer::LTileRenderer():
+    mWidth{ 0 },
+    mHeight{ 0 },
+    mTexture{ nullptr },
+    mTilesX{ 0 },
+    mTilesY{ 0 },
+    mClearColor{ 0xFF000000 },
+    mMutex{ nullptr },
+    mWorkReady{ nullptr },
+    mWorkDone{ nullptr },
+    mGeneration{ 0 },
+    mBusyWorkers{ 0 },
+    mQuit{ false }
+{
+    SDL_SetAtomicInt( &mNextTile, 0 );
+}
 
-/* Function Implementations */
-bool init()
+LTileRenderer::~LTileRenderer()
 {
-    //Initialization flag
-    bool success{ true };
+    destroy();
+}
 
-    //Initialize SDL
-    if( SDL_Init( SDL_INIT_VIDEO ) == false )
+bool LTileRenderer::init( int width, int height, int threadCount )
+{
+    //Clean up old backend
+    destroy();
+
+    //Create streaming texture
+    if( mTexture = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height ); mTexture == nullptr )
     {
-        SDL_Log( "SDL could not initialize! SDL error: %s\n", SDL_GetError() );
-        success = false;
+        SDL_Log( "Unable to create tile framebuffer texture! SDL error: %s\n", SDL_GetError() );
+        return false;
     }
-    else
+
+    //Allocate framebuffer and tile bins
+    mWidth = width;
+    mHeight = height;
+    mPixels.assign( static_cast<size_t>( width ) * height, 0 );
+    mTilesX = ( width + kTileSize - 1 ) / kTileSize;
+    mTilesY = ( height + kTileSize - 1 ) / kTileSize;
+    mTileBins.assign( mTilesX * mTilesY, std::vector<int>{} );
+
+    //Create synchronization objects
+    mMutex = SDL_CreateMutex();
+    mWorkReady = SDL_CreateCondition();
+    mWorkDone = SDL_CreateCondition();
+    mQuit = false;
+    mBusyWorkers = 0;
+
+    //Workers start waiting for generation 1 however late they first take the lock
+    mGeneration = 0;
+
+    //The calling thread rasterizes too, so start one less worker
+    for( int i = 1; i < threadCount; ++i )
     {
-        //Create window with renderer
-        if( SDL_CreateWindowAndRenderer( "SDL3 Tutorial: Textures and Extension Libraries", kScreenWidth, kScreenHeight, 0, &gWindow, &gRenderer ) == false )
+        if( SDL_Thread* worker = SDL_CreateThread( workerMain, "TileWorker", this ); worker == nullptr )
         {
-            SDL_Log( "Window could not be created! SDL error: %s\n", SDL_GetError() );
-            success = false;
+            SDL_Log( "Unable to create tile worker! SDL error: %s\n", SDL_GetError() );
+            break;
         }
         else
         {
-            //Enable VSync
-            if( SDL_SetRenderVSync( gRenderer, 1 ) == false )
-            {
-                SDL_Log( "Could not enable VSync! SDL error: %s\n", SDL_GetError() );
-                success = false;
-            }
-            
+            mWorkers.push_back( worker );
+        }
+    }
+
+    return true;
+}
+
+void LTileRenderer::destroy()
+{
+    //Wake workers and wait for them to exit
+    if( mMutex != nullptr )
+    {
+        SDL_LockMutex( mMutex );
+        mQuit = true;
+        SDL_BroadcastCondition( mWorkReady );
+        SDL_UnlockMutex( mMutex );
+    }
+    for( SDL_Thread* worker : mWorkers )
+    {
+        SDL_WaitThread( worker, nullptr );
+    }
+    mWorkers.clear();
+
+    //Free synchronization objects
+    SDL_DestroyCondition( mWorkDone );
+    mWorkDone = nullptr;
+    SDL_DestroyCondition( mWorkReady );
+    mWorkReady = nullptr;
+    SDL_DestroyMutex( mMutex );
+    mMutex = nullptr;
+
+    //Free framebuffer
+    SDL_DestroyTexture( mTexture );
+    mTexture = nullptr;
+    mPixels.clear();
+    mCommands.clear();
+    mTileBins.clear();
+    mWidth = 0;
+    mHeight = 0;
+}
+
+bool LTileRenderer::isEnabled()
+{
+    return mTexture != nullptr;
+}
+
+int LTileRenderer::getThreadCount()
+{
+    return static_cast<int>( mWorkers.size() ) + 1;
+}
+
+const Uint32* LTileRenderer::getPixels()
+{
+    return mPixels.data();
+}
+
+int LTileRenderer::getWidth()
+{
+    return mWidth;
+}
+
+int LTileRenderer::getHeight()
+{
+    return mHeight;
+}
+
+void LTileRenderer::clear( Uint8 r, Uint8 g, Uint8 b, Uint8 a )
+{
+    //Clearing overwrites everything drawn so far
+    mCommands.clear();
+    mClearColor = ( static_cast<Uint32>( a ) << 24 ) | ( static_cast<Uint32>( r ) << 16 ) | ( static_cast<Uint32>( g ) << 8 ) | b;
+}
+
+void LTileRenderer::draw( const LDrawCommand& command )
+{
+    mCommands.push_back( command );
+}
+
+void LTileRenderer::flush()
+{
+    //Bin commands into the tiles they touch
+    for( std::vector<int>& bin : mTileBins )
+    {
+        bin.clear();
+    }
+    for( int i = 0; i < static_cast<int>( mCommands.size() ); ++i )
+    {
+        SDL_Rect bounds{ getCommandBounds( mCommands[ i ] ) };
+        if( bounds.w <= 0 || bounds.h <= 0 )
+        {
+            continue;
+        }
+
+        int firstTileX{ bounds.x / kTileSize }, lastTileX{ ( bounds.x + bounds.w - 1 ) / kTileSize };
+        int firstTileY{ bounds.y / kTileSize }, lastTileY{ ( bounds.y + bounds.h - 1 ) / kTileSize };
+        for( int ty = firstTileY; ty <= lastTileY; ++ty )
+        {
+            for( int tx = firstTileX; tx <= lastTileX; ++tx )
+            {
+                mTileBins[ ty * mTilesX + tx ].push_back( i );
+            }
+        }
+    }
+
+    //Start workers on a new generation
+    SDL_SetAtomicInt( &mNextTile, 0 );
+    SDL_LockMutex( mMutex );
+    mGeneration++;
+    mBusyWorkers = static_cast<int>( mWorkers.size() );
+    SDL_BroadcastCondition( mWorkReady );
+    SDL_UnlockMutex( mMutex );
+
+    //Help out then wait for the stragglers
+    runTiles();
+    SDL_LockMutex( mMutex );
+    while( mBusyWorkers > 0 )
+    {
+        SDL_WaitCondition( mWorkDone, mMutex );
+    }
+    SDL_UnlockMutex( mMutex );
+}
+
+void LTileRenderer::present()
+{
+    //Rasterize the frame
+    flush();
+
+    //Upload and draw it over the whole window
+    SDL_UpdateTexture( mTexture, nullptr, mPixels.data(), mWidth * static_cast<int>( sizeof( Uint32 ) ) );
+    SDL_RenderTexture( gRenderer, mTexture, nullptr, nullptr );
+}
+
+int LTileRenderer::workerMain( void* data )
+{
+    LTileRenderer* renderer{ static_cast<LTileRenderer*>( data ) };
+
+    //Start from the generation init set before creating workers, a flush that ran before this thread got the lock still counts
+    int seenGeneration{ 0 };
+    SDL_LockMutex( renderer->mMutex );
+    while( true )
+    {
+        //Wait for a new frame or shutdown
+        while( renderer->mGeneration == seenGeneration && renderer->mQuit == false )
+        {
+            SDL_WaitCondition( renderer->mWorkReady, renderer->mMutex );
+        }
+        if( renderer->mQuit )
+        {
+            break;
+        }
+        seenGeneration = renderer->mGeneration;
+
+        //Rasterize without holding the lock
+        SDL_UnlockMutex( renderer->mMutex );
+        renderer->runTiles();
+        SDL_LockMutex( renderer->mMutex );
+
+        //Report back
+        if( --renderer->mBusyWorkers == 0 )
+        {
+            SDL_SignalCondition( renderer->mWorkDone );
+        }
+    }
+    SDL_UnlockMutex( renderer->mMutex );
+
+    return 0;
+}
+
+void LTileRenderer::runTiles()
+{
+    //Grab tiles until all are taken
+    const int tileCount{ mTilesX * mTilesY };
+    for( int tile = SDL_AddAtomicInt( &mNextTile, 1 ); tile < tileCount; tile = SDL_AddAtomicInt( &mNextTile, 1 ) )
+    {
+        rasterizeTile( tile );
+    }
+}
+
+void LTileRenderer::rasterizeTile( int tile )
+{
+    //Get tile area clipped to the framebuffer
+    SDL_Rect tileRect{ ( tile % mTilesX ) * kTileSize, ( tile / mTilesX ) * kTileSize, kTileSize, kTileSize };
+    tileRect.w = SDL_min( tileRect.w, mWidth - tileRect.x );
+    tileRect.h = SDL_min( tileRect.h, mHeight - tileRect.y );
+
+    //Clear tile
+    for( int y = tileRect.y; y < tileRect.y + tileRect.h; ++y )
+    {
+        std::fill_n( &mPixels[ static_cast<size_t>( y ) * mWidth + tileRect.x ], tileRect.w, mClearColor );
+    }
+
+    //Draw commands in submission order
+    for( int commandIndex : mTileBins[ tile ] )
+    {
+        rasterizeCommand( mCommands[ commandIndex ], tileRect );
+    }
+}
+
+SDL_Rect LTileRenderer::getCommandBounds( const LDrawCommand& command )
+{
+    const SDL_FRect& dst{ command.dstRect };
+    float minX{ dst.x }, minY{ dst.y }, maxX{ dst.x + dst.w }, maxY{ dst.y + dst.h };
+
+    //Rotated draws cover the box around their rotated corners
+    if( command.degrees != 0.0 )
+    {
+        const float radians{ static_cast<float>( command.degrees * SDL_PI_D / 180.0 ) };
+        const float cosine{ static_cast<float>( SDL_cos( radians ) ) }, sine{ static_cast<float>( SDL_sin( radians ) ) };
+        const SDL_FPoint corners[ 4 ] = { { 0.f, 0.f }, { dst.w, 0.f }, { 0.f, dst.h }, { dst.w, dst.h } };
+
+        minX = minY = 1e30f;
+        maxX = maxY = -1e30f;
+        for( const SDL_FPoint& corner : corners )
+        {
+            float dx{ corner.x - command.center.x }, dy{ corner.y - command.center.y };
+            float x{ dst.x + command.center.x + cosine * dx - sine * dy };
+            float y{ dst.y + command.center.y + sine * dx + cosine * dy };
+            minX = SDL_min( minX, x );
+            minY = SDL_min( minY, y );
+            maxX = SDL_max( maxX, x );
+            maxY = SDL_max( maxY, y );
+        }
+    }
+
+    //Clip to the framebuffer
+    int x0{ SDL_max( static_cast<int>( SDL_floorf( minX ) ), 0 ) }, y0{ SDL_max( static_cast<int>( SDL_floorf( minY ) ), 0 ) };
+    int x1{ SDL_min( static_cast<int>( SDL_ceilf( maxX ) ), mWidth ) }, y1{ SDL_min( static_cast<int>( SDL_ceilf( maxY ) ), mHeight ) };
+    return SDL_Rect{ x0, y0, x1 - x0, y1 - y0 };
+}
+
+void LTileRenderer::rasterizeCommand( const LDrawCommand& command, const SDL_Rect& tileRect )
+{
+    const SDL_Surface* source{ command.source };
+    const SDL_Rect& src{ command.srcRect };
+    const bool flipX{ ( command.flipMode & SDL_FLIP_HORIZONTAL ) != 0 };
+    const bool flipY{ ( command.flipMode & SDL_FLIP_VERTICAL ) != 0 };
+
+    //Gathered source pixels for one tile row
+    Uint32 span[ kTileSize ];
+
+    if( command.degrees == 0.0 )
+    {
+        //Snap destination to whole pixels like the SDL software renderer
+        SDL_Rect dst{ static_cast<int>( command.dstRect.x ), static_cast<int>( command.dstRect.y ), static_cast<int>( command.dstRect.w ), static_cast<int>( command.dstRect.h ) };
+        if( dst.w <= 0 || dst.h <= 0 )
+        {
+            return;
+        }
+
+        //Overlap with the tile
+        int x0{ SDL_max( dst.x, tileRect.x ) }, x1{ SDL_min( dst.x + dst.w, tileRect.x + tileRect.w ) };
+        int y0{ SDL_max( dst.y, tileRect.y ) }, y1{ SDL_min( dst.y + dst.h, tileRect.y + tileRect.h ) };
+        if( x0 >= x1 || y0 >= y1 )
+        {
+            return;
+        }
+
+        //16.16 nearest neighbor steps sampling pixel centers
+        const Uint64 stepX{ ( static_cast<Uint64>( src.w ) << 16 ) / dst.w };
+        const Uint64 stepY{ ( static_cast<Uint64>( src.h ) << 16 ) / dst.h };
+
+        for( int y = y0; y < y1; ++y )
+        {
+            int v{ static_cast<int>( ( ( y - dst.y ) * stepY + stepY / 2 ) >> 16 ) };
+            if( flipY )
+            {
+                v = src.h - 1 - v;
+            }
+            const Uint32* srcRow{ reinterpret_cast<const Uint32*>( static_cast<const Uint8*>( source->pixels ) + static_cast<size_t>( src.y + v ) * source->pitch ) + src.x };
+
+            for( int x = x0; x < x1; ++x )
+            {
+                int u{ static_cast<int>( ( ( x - dst.x ) * stepX + stepX / 2 ) >> 16 ) };
+                if( flipX )
+                {
+                    u = src.w - 1 - u;
+                }
+                span[ x - x0 ] = srcRow[ u ];
+            }
+
+            blendSpan( &mPixels[ static_cast<size_t>( y ) * mWidth + x0 ], span, x1 - x0, command.colorMod, command.blendMode );
+        }
+    }
+    else
+    {
+        //Map each pixel center back into the unrotated destination rectangle
+        const SDL_FRect& dst{ command.dstRect };
+        const float radians{ static_cast<float>( command.degrees * SDL_PI_D / 180.0 ) };
+        const float cosine{ static_cast<float>( SDL_cos( radians ) ) }, sine{ static_cast<float>( SDL_sin( radians ) ) };
+        const float pivotX{ dst.x + command.center.x }, pivotY{ dst.y + command.center.y };
+        const float scaleX{ src.w / dst.w }, scaleY{ src.h / dst.h };
+
+        for( int y = tileRect.y; y < tileRect.y + tileRect.h; ++y )
+        {
+            //Rotated rectangles are convex so each row covers one run of pixels
+            int runStart{ -1 }, runLength{ 0 };
+            for( int x = tileRect.x; x < tileRect.x + tileRect.w; ++x )
+            {
+                float dx{ x + 0.5f - pivotX }, dy{ y + 0.5f - pivotY };
+                float localX{ command.center.x + cosine * dx + sine * dy };
+                float localY{ command.center.y - sine * dx + cosine * dy };
+                if( localX < 0.f || localY < 0.f || localX >= dst.w || localY >= dst.h )
+                {
+                    if( runLength > 0 )
+                    {
+                        break;
+                    }
+                    continue;
+                }
+
+                int u{ SDL_min( static_cast<int>( localX * scaleX ), src.w - 1 ) };
+                int v{ SDL_min( static_cast<int>( localY * scaleY ), src.h - 1 ) };
+                if( flipX )
+                {
+                    u = src.w - 1 - u;
+                }
+                if( flipY )
+                {
+                    v = src.h - 1 - v;
+                }
+
+                if( runStart < 0 )
+                {
+                    runStart = x;
+                }
+                span[ runLength++ ] = reinterpret_cast<const Uint32*>( static_cast<const Uint8*>( source->pixels ) + static_cast<size_t>( src.y + v ) * source->pitch )[ src.x + u ];
+            }
+
+            if( runLength > 0 )
+            {
+                blendSpan( &mPixels[ static_cast<size_t>( y ) * mWidth + runStart ], span, runLength, command.colorMod, command.blendMode );
+            }
+        }
+    }
+}
+
+
+
+//LRenderRecorder Implementation
+LRenderRecorder::LRenderRecorder():
+    mFile{ nullptr }
+{
+
+}
+
+LRenderRecorder::~LRenderRecorder()
+{
+    close();
+}
+
+bool LRenderRecorder::open( std::string path )
+{
+    //Close old log
+    close();
+
+    //Open log file
+    if( mFile = SDL_IOFromFile( path.c_str(), "wb" ); mFile == nullptr )
+    {
+        SDL_Log( "Unable to open render log %s! SDL error: %s\n", path.c_str(), SDL_GetError() );
+        return false;
+    }
+
+    //Write header
+    mBuffer.reserve( 1 << 16 );
+    write( kMagic );
+    write( kVersion );
+
+    return true;
+}
+
+void LRenderRecorder::close()
+{
+    if( mFile != nullptr )
+    {
+        flush();
+        SDL_CloseIO( mFile );
+        mFile = nullptr;
+    }
+}
+
+bool LRenderRecorder::isRecording()
+{
+    return mFile != nullptr;
+}
+
+template<typename T>
+void LRenderRecorder::write( const T& value )
+{
+    const Uint8* bytes{ reinterpret_cast<const Uint8*>( &value ) };
+    mBuffer.insert( mBuffer.end(), bytes, bytes + sizeof( T ) );
+}
+
+void LRenderRecorder::writeString( const std::string& text )
+{
+    write( static_cast<Uint16>( text.size() ) );
+    mBuffer.insert( mBuffer.end(), text.begin(), text.begin() + static_cast<Uint16>( text.size() ) );
+}
+
+void LRenderRecorder::flush()
+{
+    if( mBuffer.empty() == false && SDL_WriteIO( mFile, mBuffer.data(), mBuffer.size() ) != mBuffer.size() )
+    {
+        SDL_Log( "Unable to write render log! SDL error: %s\n", SDL_GetError() );
+    }
+    mBuffer.clear();
+}
+
+void LRenderRecorder::recordLoadFile( Uint32 textureId, const std::string& path, bool premultiplyAlpha )
+{
+    write( eRenderOp::LoadFile );
+    write( textureId );
+    write( static_cast<Uint8>( premultiplyAlpha ) );
+    writeString( path );
+}
+
+void LRenderRecorder::recordLoadText( Uint32 textureId, const std::string& text, SDL_Color color )
+{
+    write( eRenderOp::LoadText );
+    write( textureId );
+    write( color );
+    writeString( text );
+}
+
+void LRenderRecorder::recordCreateBlank( Uint32 textureId, int width, int height, SDL_TextureAccess access )
+{
+    write( eRenderOp::CreateBlank );
+    write( textureId );
+    write( static_cast<Sint32>( width ) );
+    write( static_cast<Sint32>( height ) );
+    write( static_cast<Uint8>( access ) );
+}
+
+void LRenderRecorder::recordDestroy( Uint32 textureId )
+{
+    write( eRenderOp::Destroy );
+    write( textureId );
+}
+
+void LRenderRecorder::recordSetColor( Uint32 textureId, Uint8 r, Uint8 g, Uint8 b )
+{
+    write( eRenderOp::SetColor );
+    write( textureId );
+    write( r );
+    write( g );
+    write( b );
+}
+
+void LRenderRecorder::recordSetAlpha( Uint32 textureId, Uint8 alpha )
+{
+    write( eRenderOp::SetAlpha );
+    write( textureId );
+    write( alpha );
+}
+
+void LRenderRecorder::recordSetBlending( Uint32 textureId, SDL_BlendMode blendMode )
+{
+    write( eRenderOp::SetBlending );
+    write( textureId );
+    write( static_cast<Uint32>( blendMode ) );
+}
+
+void LRenderRecorder::recordRender( Uint32 textureId, float x, float y, const SDL_FRect* clip, float width, float height, double degrees, const SDL_FPoint* center, SDL_FlipMode flipMode )
+{
+    //Optional arguments are flagged so unused ones take no space
+    constexpr Uint8 kHasClip = 0x1;
+    constexpr Uint8 kHasSize = 0x2;
+    constexpr Uint8 kHasRotation = 0x4;
+    constexpr Uint8 kHasCenter = 0x8;
+    Uint8 flags{ 0 };
+    flags |= clip != nullptr ? kHasClip : 0;
+    flags |= ( width > 0 || height > 0 ) ? kHasSize : 0;
+    flags |= ( degrees != 0.0 || flipMode != SDL_FLIP_NONE ) ? kHasRotation : 0;
+    flags |= center != nullptr ? kHasCenter : 0;
+
+    write( eRenderOp::Render );
+    write( textureId );
+    write( flags );
+    write( x );
+    write( y );
+    if( flags & kHasClip )
+    {
+        write( *clip );
+    }
+    if( flags & kHasSize )
+    {
+        write( width );
+        write( height );
+    }
+    if( flags & kHasRotation )
+    {
+        write( degrees );
+        write( static_cast<Uint8>( flipMode ) );
+    }
+    if( flags & kHasCenter )
+    {
+        write( *center );
+    }
+}
+
+void LRenderRecorder::recordClear( Uint8 r, Uint8 g, Uint8 b, Uint8 a )
+{
+    write( eRenderOp::Clear );
+    write( SDL_Color{ r, g, b, a } );
+}
+
+void LRenderRecorder::recordPresent()
+{
+    write( eRenderOp::Present );
+
+    //Write whole frames once enough has built up
+    if( mBuffer.size() >= ( 1 << 16 ) )
+    {
+        flush();
+    }
+}
+
+void LRenderRecorder::recordSetTarget( Uint32 textureId )
+{
+    write( eRenderOp::SetTarget );
+    write( textureId );
+}
+
+
+//LRenderReplayer Implementation
+LRenderReplayer::LRenderReplayer():
+    mPosition{ 0 }
+{
+
+}
+
+bool LRenderReplayer::load( std::string path )
+{
+    //Read whole file
+    size_t size{ 0 };
+    void* data{ SDL_LoadFile( path.c_str(), &size ) };
+    if( data == nullptr )
+    {
+        SDL_Log( "Unable to read render log %s! SDL error: %s\n", path.c_str(), SDL_GetError() );
+        return false;
+    }
+    mLog.assign( static_cast<Uint8*>( data ), static_cast<Uint8*>( data ) + size );
+    SDL_free( data );
+
+    //Check header
+    mPosition = 0;
+    Uint32 magic{ 0 }, version{ 0 };
+    if( read( magic ) == false || read( version ) == false || magic != LRenderRecorder::kMagic || version > LRenderRecorder::kVersion )
+    {
+        SDL_Log( "%s is not a render log this build can replay!\n", path.c_str() );
+        mLog.clear();
+        return false;
+    }
+
+    return true;
+}
+
+template<typename T>
+bool LRenderReplayer::read( T& value )
+{
+    if( mPosition + sizeof( T ) > mLog.size() )
+    {
+        return false;
+    }
+    SDL_memcpy( &value, &mLog[ mPosition ], sizeof( T ) );
+    mPosition += sizeof( T );
+    return true;
+}
+
+bool LRenderReplayer::readString( std::string& text )
+{
+    Uint16 length{ 0 };
+    if( read( length ) == false || mPosition + length > mLog.size() )
+    {
+        return false;
+    }
+    text.assign( reinterpret_cast<const char*>( &mLog[ mPosition ] ), length );
+    mPosition += length;
+    return true;
+}
+
+LTexture& LRenderReplayer::getTexture( Uint32 textureId )
+{
+    std::unique_ptr<LTexture>& texture{ mTextures[ textureId ] };
+    if( texture == nullptr )
+    {
+        texture = std::make_unique<LTexture>();
+    }
+    return *texture;
+}
+
+bool LRenderReplayer::replay()
+{
+    //Argument flags matching recordRender
+    constexpr Uint8 kHasClip = 0x1;
+    constexpr Uint8 kHasSize = 0x2;
+    constexpr Uint8 kHasRotation = 0x4;
+    constexpr Uint8 kHasCenter = 0x8;
+
+    //Time each presented frame
+    LFrameBenchmark benchmark;
+    LTimer frameTimer{ &gRealClock };
+    benchmark.start();
+    frameTimer.start();
+
+    bool success{ true };
+    eRenderOp op;
+    while( success && read( op ) )
+    {
+        Uint32 textureId{ 0 };
+        switch( op )
+        {
+            case eRenderOp::LoadFile:
+            {
+                Uint8 premultiplyAlpha{ 0 };
+                std::string path;
+                success = read( textureId ) && read( premultiplyAlpha ) && readString( path );
+                if( success )
+                {
+                    getTexture( textureId ).loadFromFile( path, premultiplyAlpha != 0 );
+                }
+                break;
+            }
+
+            case eRenderOp::LoadText:
+            {
+                SDL_Color color;
+                std::string text;
+                success = read( textureId ) && read( color ) && readString( text );
+                #if defined(SDL_TTF_MAJOR_VERSION)
+                if( success )
+                {
+                    getTexture( textureId ).loadFromRenderedText( text, color );
+                }
+                #endif
+                break;
+            }
+
+            case eRenderOp::CreateBlank:
+            {
+                Sint32 width{ 0 }, height{ 0 };
+                Uint8 access{ 0 };
+                success = read( textureId ) && read( width ) && read( height ) && read( access );
+                if( success )
+                {
+                    getTexture( textureId ).createBlank( width, height, static_cast<SDL_TextureAccess>( access ) );
+                }
+                break;
+            }
+
+            case eRenderOp::SetTarget:
+                success = read( textureId );
+                if( success && textureId == 0 )
+                {
+                    resetRenderTarget();
+                }
+                else if( success )
+                {
+                    getTexture( textureId ).setAsRenderTarget();
+                }
+                break;
+
+            case eRenderOp::Destroy:
+                success = read( textureId );
+                if( success )
+                {
+                    mTextures.erase( textureId );
+                }
+                break;
+
+            case eRenderOp::SetColor:
+            {
+                Uint8 r{ 0 }, g{ 0 }, b{ 0 };
+                success = read( textureId ) && read( r ) && read( g ) && read( b );
+                if( success )
+                {
+                    getTexture( textureId ).setColor( r, g, b );
+                }
+                break;
+            }
+
+            case eRenderOp::SetAlpha:
+            {
+                Uint8 alpha{ 0 };
+                success = read( textureId ) && read( alpha );
+                if( success )
+                {
+                    getTexture( textureId ).setAlpha( alpha );
+                }
+                break;
+            }
+
+            case eRenderOp::SetBlending:
+            {
+                Uint32 blendMode{ 0 };
+                success = read( textureId ) && read( blendMode );
+                if( success )
+                {
+                    getTexture( textureId ).setBlending( static_cast<SDL_BlendMode>( blendMode ) );
+                }
+                break;
+            }
+
+            case eRenderOp::Render:
+            {
+                //Unused optional arguments keep LTexture::render's defaults
+                Uint8 flags{ 0 };
+                float x{ 0.f }, y{ 0.f }, width{ LTexture::kOriginalSize }, height{ LTexture::kOriginalSize };
+                SDL_FRect clip{ 0.f, 0.f, 0.f, 0.f };
+                SDL_FPoint center{ 0.f, 0.f };
+                double degrees{ 0.0 };
+                Uint8 flipMode{ SDL_FLIP_NONE };
+                success = read( textureId ) && read( flags ) && read( x ) && read( y );
+                success = success && ( ( flags & kHasClip ) == 0 || read( clip ) );
+                success = success && ( ( flags & kHasSize ) == 0 || ( read( width ) && read( height ) ) );
+                success = success && ( ( flags & kHasRotation ) == 0 || ( read( degrees ) && read( flipMode ) ) );
+                success = success && ( ( flags & kHasCenter ) == 0 || read( center ) );
+                if( success )
+                {
+                    getTexture( textureId ).render( x, y, ( flags & kHasClip ) ? &clip : nullptr, width, height, degrees, ( flags & kHasCenter ) ? &center : nullptr, static_cast<SDL_FlipMode>( flipMode ) );
+                }
+                break;
+            }
+
+            case eRenderOp::Clear:
+            {
+                SDL_Color color;
+                success = read( color );
+                if( success )
+                {
+                    renderClear( color.r, color.g, color.b, color.a );
+                }
+                break;
+            }
+
+            case eRenderOp::Present:
+                renderPresent();
+                benchmark.addFrame( frameTimer.getTicksNS(), gLastFrameCounters );
+                frameTimer.start();
+                break;
+
+            default:
+                SDL_Log( "Unknown render log operation %d at byte %d!\n", static_cast<int>( op ), static_cast<int>( mPosition - 1 ) );
+                success = false;
+                break;
+        }
+    }
+
+    if( success == false )
+    {
+        SDL_Log( "Render log is truncated or corrupt, stopped after %d frames\n", benchmark.getFrameCount() );
+    }
+
+    //Report and free replay textures
+    benchmark.report();
+    mTextures.clear();
+
+    return success;
+}
+
+//LFrameCapture Implementation
+LFrameCapture::LFrameCapture():
+    mRawOutput{ false },
+    mMutex{ nullptr },
+    mWorkReady{ nullptr },
+    mQuit{ false },
+    mFrameIndex{ 0 },
+    mWrittenFrames{ 0 },
+    mDroppedFrames{ 0 }
+{
+
+}
+
+LFrameCapture::~LFrameCapture()
+{
+    stop();
+}
+
+bool LFrameCapture::start( std::string directory, bool rawOutput, int poolSize, int workerCount )
+{
+    //Stop old capture
+    stop();
+
+    //Make sure the output directory exists
+    if( SDL_CreateDirectory( directory.c_str() ) == false )
+    {
+        SDL_Log( "Unable to create capture directory %s! SDL error: %s\n", directory.c_str(), SDL_GetError() );
+        return false;
+    }
+    mDirectory = directory;
+    mRawOutput = rawOutput;
+
+    //Allocate the pool up front so capturing never allocates frames
+    mBuffers.assign( poolSize, LCaptureBuffer{ std::vector<Uint32>( static_cast<size_t>( kScreenWidth ) * kScreenHeight ), kScreenWidth, kScreenHeight, 0, nullptr } );
+    mFreeBuffers.clear();
+    for( int i = poolSize - 1; i >= 0; --i )
+    {
+        mFreeBuffers.push_back( i );
+    }
+    mPendingBuffers.clear();
+
+    //Start encoders
+    mMutex = SDL_CreateMutex();
+    mWorkReady = SDL_CreateCondition();
+    mQuit = false;
+    mFrameIndex = 0;
+    mWrittenFrames = 0;
+    mDroppedFrames = 0;
+    for( int i = 0; i < workerCount; ++i )
+    {
+        if( SDL_Thread* worker = SDL_CreateThread( workerMain, "CaptureEncoder", this ); worker == nullptr )
+        {
+            SDL_Log( "Unable to create capture encoder! SDL error: %s\n", SDL_GetError() );
+            break;
+        }
+        else
+        {
+            mWorkers.push_back( worker );
+        }
+    }
+
+    //Need at least one encoder
+    if( mWorkers.empty() )
+    {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void LFrameCapture::stop()
+{
+    if( mMutex == nullptr )
+    {
+        return;
+    }
+
+    //Encoders finish the queue before they exit
+    SDL_LockMutex( mMutex );
+    mQuit = true;
+    SDL_BroadcastCondition( mWorkReady );
+    SDL_UnlockMutex( mMutex );
+    for( SDL_Thread* worker : mWorkers )
+    {
+        SDL_WaitThread( worker, nullptr );
+    }
+    mWorkers.clear();
+
+    SDL_Log( "Frame capture: %d written, %d dropped\n", static_cast<int>( mWrittenFrames ), static_cast<int>( mDroppedFrames ) );
+
+    //Free synchronization objects and the pool
+    SDL_DestroyCondition( mWorkReady );
+    mWorkReady = nullptr;
+    SDL_DestroyMutex( mMutex );
+    mMutex = nullptr;
+    mBuffers.clear();
+    mFreeBuffers.clear();
+    mPendingBuffers.clear();
+}
+
+bool LFrameCapture::isCapturing()
+{
+    return mMutex != nullptr;
+}
+
+void LFrameCapture::captureFrame()
+{
+    //Take a free buffer or drop the frame
+    Uint64 frameIndex{ mFrameIndex++ };
+    SDL_LockMutex( mMutex );
+    int bufferIndex{ -1 };
+    if( mFreeBuffers.empty() )
+    {
+        mDroppedFrames++;
+    }
+    else
+    {
+        bufferIndex = mFreeBuffers.back();
+        mFreeBuffers.pop_back();
+    }
+    SDL_UnlockMutex( mMutex );
+    if( bufferIndex < 0 )
+    {
+        return;
+    }
+
+    //Copy the tiled framebuffer straight into the pooled buffer, it is already ARGB8888
+    LCaptureBuffer& buffer{ mBuffers[ bufferIndex ] };
+    buffer.frameIndex = frameIndex;
+    buffer.readback = nullptr;
+    bool captured{ false };
+    if( gTileRenderer.isEnabled() )
+    {
+        buffer.width = SDL_min( gTileRenderer.getWidth(), kScreenWidth );
+        buffer.height = SDL_min( gTileRenderer.getHeight(), kScreenHeight );
+        for( int y = 0; y < buffer.height; ++y )
+        {
+            std::copy_n( gTileRenderer.getPixels() + static_cast<size_t>( y ) * gTileRenderer.getWidth(), buffer.width, buffer.pixels.data() + static_cast<size_t>( y ) * buffer.width );
+        }
+        captured = true;
+    }
+    //SDL3 can only read the renderer back into a new surface, so hand that to the encoder to convert
+    else if( buffer.readback = SDL_RenderReadPixels( gRenderer, nullptr ); buffer.readback == nullptr )
+    {
+        SDL_Log( "Unable to read back frame! SDL error: %s\n", SDL_GetError() );
+    }
+    else
+    {
+        buffer.width = SDL_min( buffer.readback->w, kScreenWidth );
+        buffer.height = SDL_min( buffer.readback->h, kScreenHeight );
+        captured = true;
+    }
+
+    //Queue for encoding or give the buffer back
+    SDL_LockMutex( mMutex );
+    if( captured )
+    {
+        mPendingBuffers.push_back( bufferIndex );
+        SDL_SignalCondition( mWorkReady );
+    }
+    else
+    {
+        mFreeBuffers.push_back( bufferIndex );
+    }
+    SDL_UnlockMutex( mMutex );
+}
+
+int LFrameCapture::workerMain( void* data )
+{
+    LFrameCapture* capture{ static_cast<LFrameCapture*>( data ) };
+
+    SDL_LockMutex( capture->mMutex );
+    while( true )
+    {
+        //Wait for a frame, exiting only once the queue is empty
+        while( capture->mPendingBuffers.empty() && capture->mQuit == false )
+        {
+            SDL_WaitCondition( capture->mWorkReady, capture->mMutex );
+        }
+        if( capture->mPendingBuffers.empty() )
+        {
+            break;
+        }
+        int bufferIndex{ capture->mPendingBuffers.front() };
+        capture->mPendingBuffers.pop_front();
+
+        //Encode without holding the lock
+        SDL_UnlockMutex( capture->mMutex );
+        capture->encode( capture->mBuffers[ bufferIndex ] );
+        SDL_LockMutex( capture->mMutex );
+
+        //Return buffer to the pool
+        capture->mFreeBuffers.push_back( bufferIndex );
+        capture->mWrittenFrames++;
+    }
+    SDL_UnlockMutex( capture->mMutex );
+
+    return 0;
+}
+
+void LFrameCapture::encode( LCaptureBuffer& buffer )
+{
+    //Convert GPU readbacks into the pooled pixels off the main thread
+    if( buffer.readback != nullptr )
+    {
+        bool converted{ SDL_ConvertPixels( buffer.width, buffer.height, buffer.readback->format, buffer.readback->pixels, buffer.readback->pitch,
+            SDL_PIXELFORMAT_ARGB8888, buffer.pixels.data(), buffer.width * static_cast<int>( sizeof( Uint32 ) ) ) };
+        SDL_DestroySurface( buffer.readback );
+        buffer.readback = nullptr;
+        if( converted == false )
+        {
+            SDL_Log( "Unable to convert captured frame! SDL error: %s\n", SDL_GetError() );
+            return;
+        }
+    }
+
+    //Number frames so the sequence sorts by name
+    char fileName[ 64 ];
+    const int pitch{ buffer.width * static_cast<int>( sizeof( Uint32 ) ) };
+    if( mRawOutput )
+    {
+        //Raw frames carry their size in the name
+        SDL_snprintf( fileName, sizeof( fileName ), "frame_%06d_%dx%d.argb", static_cast<int>( buffer.frameIndex ), buffer.width, buffer.height );
+        std::string path{ mDirectory + "/" + fileName };
+        if( SDL_SaveFile( path.c_str(), buffer.pixels.data(), static_cast<size_t>( pitch ) * buffer.height ) == false )
+        {
+            SDL_Log( "Unable to write %s! SDL error: %s\n", path.c_str(), SDL_GetError() );
+        }
+    }
+    else
+    {
+        //Wrap the buffer without copying and let SDL_image encode it
+        SDL_snprintf( fileName, sizeof( fileName ), "frame_%06d.png", static_cast<int>( buffer.frameIndex ) );
+        std::string path{ mDirectory + "/" + fileName };
+        if( SDL_Surface* surface = SDL_CreateSurfaceFrom( buffer.width, buffer.height, SDL_PIXELFORMAT_ARGB8888, buffer.pixels.data(), pitch ); surface == nullptr )
+        {
+            SDL_Log( "Unable to wrap captured frame! SDL error: %s\n", SDL_GetError() );
+        }
+        else
+        {
+            if( IMG_SavePNG( surface, path.c_str() ) == false )
+            {
+                SDL_Log( "Unable to write %s! SDL_image error: %s\n", path.c_str(), SDL_GetError() );
+            }
+            SDL_DestroySurface( surface );
+        }
+    }
+}
+
+//LTilemap Implementation
+LTilemap::LTilemap():
+    mTileSheet{ nullptr },
+    mTileWidth{ 0 },
+    mTileHeight{ 0 },
+    mColumns{ 0 },
+    mRows{ 0 },
+    mChunkColumns{ 0 },
+    mChunkRows{ 0 },
+    mMaxCachedChunks{ 0 }
+{
+
+}
+
+LTilemap::~LTilemap()
+{
+    destroy();
+}
+
+bool LTilemap::init( LTexture* tileSheet, const std::vector<SDL_FRect>& tileClips, int tileWidth, int tileHeight, int columns, int rows, int maxCachedChunks )
+{
+    //Clean up old map
+    destroy();
+
+    if( tileSheet == nullptr || tileClips.empty() || tileWidth <= 0 || tileHeight <= 0 || columns <= 0 || rows <= 0 || maxCachedChunks <= 0 )
+    {
+        SDL_Log( "Invalid tilemap settings!\n" );
+        return false;
+    }
+
+    //Set map layout
+    mTileSheet = tileSheet;
+    mTileClips = tileClips;
+    mTileWidth = tileWidth;
+    mTileHeight = tileHeight;
+    mColumns = columns;
+    mRows = rows;
+    mChunkColumns = ( columns + kChunkTiles - 1 ) / kChunkTiles;
+    mChunkRows = ( rows + kChunkTiles - 1 ) / kChunkTiles;
+    mMaxCachedChunks = maxCachedChunks;
+
+    //Start with every tile set to the first clip and no chunk textures
+    mTiles.assign( static_cast<size_t>( columns ) * rows, 0 );
+    mChunks.resize( static_cast<size_t>( mChunkColumns ) * mChunkRows );
+    for( LChunk& chunk : mChunks )
+    {
+        chunk.lruPosition = mLru.end();
+        chunk.dirty = true;
+    }
+
+    return true;
+}
+
+void LTilemap::destroy()
+{
+    mChunks.clear();
+    mLru.clear();
+    mTiles.clear();
+    mTileClips.clear();
+    mTileSheet = nullptr;
+    mColumns = 0;
+    mRows = 0;
+    mChunkColumns = 0;
+    mChunkRows = 0;
+}
+
+void LTilemap::setTile( int column, int row, Uint8 tile )
+{
+    if( column < 0 || row < 0 || column >= mColumns || row >= mRows )
+    {
+        return;
+    }
+
+    //Redraw the chunk next time it is shown
+    mTiles[ static_cast<size_t>( row ) * mColumns + column ] = tile;
+    mChunks[ ( row / kChunkTiles ) * mChunkColumns + column / kChunkTiles ].dirty = true;
+}
+
+Uint8 LTilemap::getTile( int column, int row )
+{
+    if( column < 0 || row < 0 || column >= mColumns || row >= mRows )
+    {
+        return 0;
+    }
+
+    return mTiles[ static_cast<size_t>( row ) * mColumns + column ];
+}
+
+int LTilemap::getPixelWidth()
+{
+    return mColumns * mTileWidth;
+}
+
+int LTilemap::getPixelHeight()
+{
+    return mRows * mTileHeight;
+}
+
+int LTilemap::getCachedChunkCount()
+{
+    return static_cast<int>( mLru.size() );
+}
+
+void LTilemap::render( float cameraX, float cameraY )
+{
+    if( mTileSheet == nullptr )
+    {
+        return;
+    }
+
+    //Find the chunks overlapping the visible area
+    const float chunkWidth{ static_cast<float>( kChunkTiles * mTileWidth ) }, chunkHeight{ static_cast<float>( kChunkTiles * mTileHeight ) };
+    int firstChunkX{ SDL_max( static_cast<int>( SDL_floorf( ( cameraX + gCullRect.x ) / chunkWidth ) ), 0 ) };
+    int firstChunkY{ SDL_max( static_cast<int>( SDL_floorf( ( cameraY + gCullRect.y ) / chunkHeight ) ), 0 ) };
+    int lastChunkX{ SDL_min( static_cast<int>( SDL_floorf( ( cameraX + gCullRect.x + gCullRect.w - 1.f ) / chunkWidth ) ), mChunkColumns - 1 ) };
+    int lastChunkY{ SDL_min( static_cast<int>( SDL_floorf( ( cameraY + gCullRect.y + gCullRect.h - 1.f ) / chunkHeight ) ), mChunkRows - 1 ) };
+
+    for( int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY )
+    {
+        for( int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX )
+        {
+            int chunk{ chunkY * mChunkColumns + chunkX };
+            float screenX{ chunkX * chunkWidth - cameraX }, screenY{ chunkY * chunkHeight - cameraY };
+
+            //The tiled backend can't draw into textures so it gets the tiles directly
+            if( LTexture* texture = gTileRenderer.isEnabled() ? nullptr : acquireChunk( chunk ); texture == nullptr )
+            {
+                renderChunkTiles( chunk, screenX, screenY );
+            }
+            else
+            {
+                texture->render( screenX, screenY );
+            }
+        }
+    }
+}
+
+LTexture* LTilemap::acquireChunk( int chunk )
+{
+    LChunk& entry{ mChunks[ chunk ] };
+
+    //Cached chunks move to the front
+    if( entry.texture != nullptr )
+    {
+        mLru.splice( mLru.begin(), mLru, entry.lruPosition );
+    }
+    else
+    {
+        //Take the least recently drawn chunk's texture once the cache is full
+        if( static_cast<int>( mLru.size() ) >= mMaxCachedChunks )
+        {
+            int evicted{ mLru.back() };
+            mLru.pop_back();
+            entry.texture = std::move( mChunks[ evicted ].texture );
+            mChunks[ evicted ].lruPosition = mLru.end();
+        }
+        else
+        {
+            //Make a new chunk texture
+            entry.texture = std::make_unique<LTexture>();
+            if( entry.texture->createBlank( kChunkTiles * mTileWidth, kChunkTiles * mTileHeight ) == false )
+            {
+                entry.texture.reset();
+                return nullptr;
+            }
+        }
+
+        mLru.push_front( chunk );
+        entry.lruPosition = mLru.begin();
+        entry.dirty = true;
+    }
+
+    //Redraw stale chunks
+    if( entry.dirty )
+    {
+        buildChunk( chunk );
+        entry.dirty = false;
+    }
+
+    return entry.texture.get();
+}
+
+void LTilemap::buildChunk( int chunk )
+{
+    //Chunks are built mid frame, so remember the scene's target and view
+    LTexture* oldTarget{ gRenderTarget };
+    SDL_Rect oldViewport{ 0, 0, 0, 0 }, oldClip{ 0, 0, 0, 0 };
+    float oldScaleX{ 1.f }, oldScaleY{ 1.f };
+    bool oldClipEnabled{ SDL_RenderClipEnabled( gRenderer ) };
+    SDL_GetRenderViewport( gRenderer, &oldViewport );
+    SDL_GetRenderClipRect( gRenderer, &oldClip );
+    SDL_GetRenderScale( gRenderer, &oldScaleX, &oldScaleY );
+
+    //Draw tiles into the whole chunk at full scale over transparent pixels
+    mChunks[ chunk ].texture->setAsRenderTarget();
+    SDL_SetRenderScale( gRenderer, 1.f, 1.f );
+    SDL_SetRenderViewport( gRenderer, nullptr );
+    SDL_SetRenderClipRect( gRenderer, nullptr );
+    updateCullRect();
+    renderClear( 0x00, 0x00, 0x00, 0x00 );
+    renderChunkTiles( chunk, 0.f, 0.f );
+
+    //Go back to the scene's target and view
+    if( oldTarget != nullptr )
+    {
+        oldTarget->setAsRenderTarget();
+    }
+    else
+    {
+        resetRenderTarget();
+    }
+    SDL_SetRenderScale( gRenderer, oldScaleX, oldScaleY );
+    SDL_SetRenderViewport( gRenderer, &oldViewport );
+    SDL_SetRenderClipRect( gRenderer, oldClipEnabled ? &oldClip : nullptr );
+    updateCullRect();
+}
+
+void LTilemap::renderChunkTiles( int chunk, float screenX, float screenY )
+{
+    //Tiles in this chunk, clamped at the map's edge
+    int firstColumn{ ( chunk % mChunkColumns ) * kChunkTiles }, firstRow{ ( chunk / mChunkColumns ) * kChunkTiles };
+    int lastColumn{ SDL_min( firstColumn + kChunkTiles, mColumns ) }, lastRow{ SDL_min( firstRow + kChunkTiles, mRows ) };
+
+    for( int row = firstRow; row < lastRow; ++row )
+    {
+        for( int column = firstColumn; column < lastColumn; ++column )
+        {
+            SDL_FRect& clip{ mTileClips[ mTiles[ static_cast<size_t>( row ) * mColumns + column ] % mTileClips.size() ] };
+            mTileSheet->render( screenX + ( column - firstColumn ) * mTileWidth, screenY + ( row - firstRow ) * mTileHeight, &clip, static_cast<float>( mTileWidth ), static_cast<float>( mTileHeight ) );
+        }
+    }
+}
+
+//LDynamicResolution Implementation
+LDynamicResolution::LDynamicResolution():
+    mScale{ 1.f },
+    mFrameBudgetNs{ 0 },
+    mAverageFrameNs{ 0.0 },
+    mSlowFrames{ 0 },
+    mFastFrames{ 0 }
+{
+
+}
+
+bool LDynamicResolution::init( Uint64 frameBudgetNs )
+{
+    //Render at full size until frames run slow
+    mScale = 1.f;
+    mFrameBudgetNs = frameBudgetNs;
+    mAverageFrameNs = 0.0;
+    mSlowFrames = 0;
+    mFastFrames = 0;
+
+    //Scaled frames use the top left of one full size target so changing scale never reallocates
+    return mTarget.createBlank( kScreenWidth, kScreenHeight );
+}
+
+void LDynamicResolution::destroy()
+{
+    mTarget.destroy();
+}
+
+bool LDynamicResolution::isEnabled()
+{
+    return mTarget.isLoaded();
+}
+
+float LDynamicResolution::getScale()
+{
+    return mScale;
+}
+
+void LDynamicResolution::beginFrame()
+{
+    //Scene keeps drawing in window coordinates while SDL scales them down
+    mTarget.setAsRenderTarget();
+    SDL_SetRenderScale( gRenderer, mScale, mScale );
+    SDL_Rect viewport{ 0, 0, kScreenWidth, kScreenHeight };
+    SDL_SetRenderViewport( gRenderer, &viewport );
+    updateCullRect();
+}
+
+void LDynamicResolution::endFrame()
+{
+    //Back to the window at full scale
+    SDL_SetRenderViewport( gRenderer, nullptr );
+    SDL_SetRenderScale( gRenderer, 1.f, 1.f );
+    resetRenderTarget();
+
+    //Stretch the drawn part over the window
+    SDL_FRect sceneClip{ 0.f, 0.f, SDL_roundf( kScreenWidth * mScale ), SDL_roundf( kScreenHeight * mScale ) };
+    mTarget.render( 0.f, 0.f, &sceneClip, static_cast<float>( kScreenWidth ), static_cast<float>( kScreenHeight ) );
+}
+
+void LDynamicResolution::update( Uint64 frameNs )
+{
+    //Smooth out single spikes
+    constexpr double kSmoothing = 0.1;
+    mAverageFrameNs = mAverageFrameNs == 0.0 ? static_cast<double>( frameNs ) : mAverageFrameNs + kSmoothing * ( static_cast<double>( frameNs ) - mAverageFrameNs );
+
+    //Count how long frames have stayed near or well under budget
+    double budgetUsed{ mAverageFrameNs / static_cast<double>( mFrameBudgetNs ) };
+    mSlowFrames = budgetUsed > kLowerThreshold ? mSlowFrames + 1 : 0;
+    mFastFrames = budgetUsed < kRaiseThreshold ? mFastFrames + 1 : 0;
+
+    //Step the scale once a trend holds
+    float newScale{ mScale };
+    if( mSlowFrames >= kLowerFrames )
+    {
+        newScale = SDL_max( mScale - kScaleStep, kMinScale );
+    }
+    else if( mFastFrames >= kRaiseFrames )
+    {
+        newScale = SDL_min( mScale + kScaleStep, 1.f );
+    }
+
+    if( newScale != mScale )
+    {
+        SDL_Log( "Dynamic resolution: %.0f%% budget used, scale %.1f -> %.1f\n", budgetUsed * 100.0, mScale, newScale );
+        mScale = newScale;
+        mSlowFrames = 0;
+        mFastFrames = 0;
+    }
+}
+
+/* Function Implementations */
+void parseArguments( int argc, char* args[] )
+{
+    //Environment defaults
+    if( const char* headless = SDL_getenv( "LAZYFOO_HEADLESS" ); headless != nullptr && SDL_strcmp( headless, "0" ) != 0 )
+    {
+        gHeadless = true;
+    }
+    if( const char* frames = SDL_getenv( "LAZYFOO_FRAMES" ); frames != nullptr )
+    {
+        gBenchmarkFrames = SDL_atoi( frames );
+    }
+
+    //Command line overrides the environment
+    for( int i = 1; i < argc; ++i )
+    {
+        if( SDL_strcmp( args[ i ], "--headless" ) == 0 )
+        {
+            gHeadless = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--frames" ) == 0 && i + 1 < argc )
+        {
+            gBenchmarkFrames = SDL_atoi( args[ ++i ] );
+        }
+        else if( SDL_strcmp( args[ i ], "--tiled" ) == 0 )
+        {
+            gTileThreads = SDL_GetNumLogicalCPUCores();
+        }
+        else if( SDL_strcmp( args[ i ], "--tiled-threads" ) == 0 && i + 1 < argc )
+        {
+            gTileThreads = SDL_max( SDL_atoi( args[ ++i ] ), 1 );
+        }
+        else if( SDL_strcmp( args[ i ], "--tiled-bench" ) == 0 )
+        {
+            gTileBenchmark = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--blend-kernel" ) == 0 && i + 1 < argc )
+        {
+            gBlendKernelName = args[ ++i ];
+        }
+        else if( SDL_strcmp( args[ i ], "--blend-validate" ) == 0 )
+        {
+            gBlendValidate = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--blend-bench" ) == 0 )
+        {
+            gBlendBenchmark = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--premultiplied" ) == 0 )
+        {
+            gPremultiplyAlpha = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--record" ) == 0 && i + 1 < argc )
+        {
+            gRecordPath = args[ ++i ];
+        }
+        else if( SDL_strcmp( args[ i ], "--replay" ) == 0 && i + 1 < argc )
+        {
+            gReplayPath = args[ ++i ];
+        }
+        else if( SDL_strcmp( args[ i ], "--capture" ) == 0 && i + 1 < argc )
+        {
+            gCapturePath = args[ ++i ];
+        }
+        else if( SDL_strcmp( args[ i ], "--capture-raw" ) == 0 )
+        {
+            gCaptureRaw = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--tilemap" ) == 0 )
+        {
+            gTilemapScene = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--dynamic-resolution" ) == 0 )
+        {
+            gDynamicResolutionEnabled = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--pacing" ) == 0 && i + 1 < argc )
+        {
+            gFramePacing = SDL_strcmp( args[ ++i ], "sleep" ) == 0 ? LFramePacer::ePacing::Sleep : LFramePacer::ePacing::Hybrid;
+        }
+        else if( SDL_strcmp( args[ i ], "--clock" ) == 0 && i + 1 < argc )
+        {
+            gClockName = args[ ++i ];
+        }
+        else if( SDL_strcmp( args[ i ], "--time-scale" ) == 0 && i + 1 < argc )
+        {
+            gTimeScale = SDL_atof( args[ ++i ] );
+        }
+    }
+
+    //Replays run headless as fast as possible
+    if( gReplayPath != nullptr )
+    {
+        gHeadless = true;
+    }
+
+    //The scaling benchmark needs the tiled backend's pixel copies
+    if( gTileBenchmark && gTileThreads == 0 )
+    {
+        gTileThreads = SDL_GetNumLogicalCPUCores();
+    }
+
+    //Fall back to the default on bad counts
+    if( gBenchmarkFrames <= 0 )
+    {
+        gBenchmarkFrames = kDefaultBenchmarkFrames;
+    }
+
+    //Headless runs step time instead of sleeping through it
+    if( gClockName == nullptr )
+    {
+        gClockName = gHeadless ? "stepped" : "real";
+    }
+    if( SDL_strcmp( gClockName, "stepped" ) == 0 )
+    {
+        gVirtualClock = std::make_unique<LSteppedClock>();
+        gClock = gVirtualClock.get();
+    }
+    else if( SDL_strcmp( gClockName, "scaled" ) == 0 )
+    {
+        if( gTimeScale > 0.0 )
+        {
+            gVirtualClock = std::make_unique<LScaledClock>( gRealClock, gTimeScale );
+            gClock = gVirtualClock.get();
+        }
+        else
+        {
+            SDL_Log( "Time scale %g is not positive, using the real clock\n", gTimeScale );
+        }
+    }
+    else if( SDL_strcmp( gClockName, "real" ) != 0 )
+    {
+        SDL_Log( "Unknown clock %s, using the real clock\n", gClockName );
+    }
+}
+
+bool init()
+{
+    //Initialization flag
+    bool success{ true };
+
+    //Use a display-less video driver and the software renderer
+    if( gHeadless )
+    {
+        SDL_SetHint( SDL_HINT_VIDEO_DRIVER, "offscreen,dummy" );
+        SDL_SetHint( SDL_HINT_RENDER_DRIVER, SDL_SOFTWARE_RENDERER );
+    }
+
+    //Initialize SDL
+    if( SDL_Init( SDL_INIT_VIDEO ) == false )
+    {
+        SDL_Log( "SDL could not initialize! SDL error: %s\n", SDL_GetError() );
+        success = false;
+    }
+    else
+    {
+        //Create window with renderer
+        if( SDL_CreateWindowAndRenderer( "SDL3 Tutorial: Textures and Extension Libraries", kScreenWidth, kScreenHeight, 0, &gWindow, &gRenderer ) == false )
+        {
+            SDL_Log( "Window could not be created! SDL error: %s\n", SDL_GetError() );
+            success = false;
+        }
+        else
+        {
+            //Enable VSync unless benchmarking
+            if( SDL_SetRenderVSync( gRenderer, gHeadless ? SDL_RENDERER_VSYNC_DISABLED : 1 ) == false )
+            {
+                SDL_Log( "Could not set VSync! SDL error: %s\n", SDL_GetError() );
+                success = false;
+            }
+            
             //Initialize the font loading
             if( TTF_Init() == false )
             {
-                SDL_Log( "SDL_ttf could not initialize! SDL_ttf error: %s\n", SDL_GetError() );
-                success = false;
+                SDL_Log( "SDL_ttf could not initialize! SDL_ttf error: %s\n", SDL_GetError() );
+                success = false;
+            }
+
+            //Pick blend kernel before anything rasterizes
+            selectBlendKernel();
+
+            //Premultiplied source over destination for both color and alpha
+            gPremultipliedBlendMode = SDL_ComposeCustomBlendMode(
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD );
+
+            //Start the tiled rasterizer before media loads so textures keep their pixels
+            if( gTileThreads > 0 && gTileRenderer.init( kScreenWidth, kScreenHeight, gTileThreads ) == false )
+            {
+                SDL_Log( "Unable to start tiled rendering!\n" );
+                success = false;
+            }
+
+            //Cull against the backend's visible area
+            updateCullRect();
+
+            //Start logging render calls before media loads
+            if( gRecordPath != nullptr && gRenderRecorder.open( gRecordPath ) == false )
+            {
+                SDL_Log( "Unable to record render calls!\n" );
+                success = false;
+            }
+
+            //Scale the scene offscreen, the tiled backend only draws at full size
+            if( gDynamicResolutionEnabled && gTileRenderer.isEnabled() )
+            {
+                SDL_Log( "Dynamic resolution is not available with tiled rendering\n" );
+            }
+            //The render log has no scale or viewport ops, so replays would draw full size
+            else if( gDynamicResolutionEnabled && gRenderRecorder.isRecording() )
+            {
+                SDL_Log( "Dynamic resolution is not available while recording render calls\n" );
+            }
+            else if( gDynamicResolutionEnabled && gDynamicResolution.init( 1000000000 / kScreenFps ) == false )
+            {
+                SDL_Log( "Unable to start dynamic resolution!\n" );
+                success = false;
+            }
+
+            //Start frame capture encoders
+            if( gCapturePath != nullptr && gFrameCapture.start( gCapturePath, gCaptureRaw ) == false )
+            {
+                SDL_Log( "Unable to start frame capture!\n" );
+                success = false;
+            }
+        }
+    }
+
+    return success;
+}
+
+
+bool loadMedia()
+{
+    //File loading flag
+    bool success{ true };
+
+    
+    //Load scene font
+    // std::string fontPath{ "12-frame-rate-and-vsync/lazy.ttf" };
+    // if( gFont = TTF_OpenFont( fontPath.c_str(), 28 ); gFont == nullptr )
+    // {
+    //     SDL_Log( "Could not load %s! SDL_ttf Error: %s\n", fontPath.c_str(), SDL_GetError() );
+    //     success = false;
+    // }
+    // else
+    // {
+    //     //Load text
+    //     SDL_Color textColor{ 0x00, 0x00, 0x00, 0xFF };
+    //     if( gFpsTexture.loadFromRenderedText( "The quick brown fox jumps over the lazy dog", textColor ) == false )
+    //     {
+    //         SDL_Log( "Could not load text texture %s! SDL_ttf Error: %s\n", fontPath.c_str(), SDL_GetError() );
+    //         success = false;
+    //     }
+    // }
+
+    //Load scene images
+    if( gSpriteSheetTexture.loadFromFile( "14-animation/foo-sprites.png", gPremultiplyAlpha ) == false )
+    {
+        SDL_Log( "Unable to load foo image!\n");
+        success = false;
+    }
+
+    //Build a large map out of the four dot sprites
+    if( gTilemapScene )
+    {
+        if( gDotsTexture.loadFromFile( "05-sprite-clipping-and-stretching/dots.png" ) == false )
+        {
+            SDL_Log( "Unable to load dots image!\n");
+            success = false;
+        }
+        else
+        {
+            constexpr int kMapTiles = 256;
+            constexpr int kTileSize = 32;
+            const std::vector<SDL_FRect> dotClips{ { 0.f, 0.f, 100.f, 100.f }, { 100.f, 0.f, 100.f, 100.f }, { 0.f, 100.f, 100.f, 100.f }, { 100.f, 100.f, 100.f, 100.f } };
+            if( gTilemap.init( &gDotsTexture, dotClips, kTileSize, kTileSize, kMapTiles, kMapTiles ) == false )
+            {
+                success = false;
+            }
+            else
+            {
+                //Scatter the dots in a repeating but irregular pattern
+                for( int row = 0; row < kMapTiles; ++row )
+                {
+                    for( int column = 0; column < kMapTiles; ++column )
+                    {
+                        gTilemap.setTile( column, row, static_cast<Uint8>( ( column * 7 + row * 13 + column * row / 5 ) % dotClips.size() ) );
+                    }
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+
+void close()
+{
+    //Clean up texture
+    gSpriteSheetTexture.destroy();
+    gTilemap.destroy();
+    gDotsTexture.destroy();
+
+    //Free font
+    TTF_CloseFont( gFont );
+    gFont = nullptr;
+
+    //Stop tiled rasterizer and offscreen scaling
+    gTileRenderer.destroy();
+    gDynamicResolution.destroy();
+
+    //Finish render log
+    gRenderRecorder.close();
+
+    //Write queued frames
+    gFrameCapture.stop();
+
+    //Clean up button
+    // gFpsTexture.destroy();
+
+    //Destroy window
+    SDL_DestroyRenderer( gRenderer );
+    gRenderer = nullptr;
+    SDL_DestroyWindow( gWindow );
+    gWindow = nullptr;
+
+    //Quit SDL subsystems
+    TTF_Quit();
+    SDL_Quit();
+}
+
+
+void renderClear( Uint8 r, Uint8 g, Uint8 b, Uint8 a )
+{
+    if( gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordClear( r, g, b, a );
+    }
+
+    if( gTileRenderer.isEnabled() )
+    {
+        gTileRenderer.clear( r, g, b, a );
+    }
+    else
+    {
+        SDL_SetRenderDrawColor( gRenderer, r, g, b, a );
+        SDL_RenderClear( gRenderer );
+    }
+}
+
+void renderPresent()
+{
+    if( gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordPresent();
+    }
+
+    //Rasterize tiles and copy them to the window first
+    if( gTileRenderer.isEnabled() )
+    {
+        gTileRenderer.present();
+    }
+
+    //Read back before presenting leaves the back buffer undefined
+    if( gFrameCapture.isCapturing() )
+    {
+        gFrameCapture.captureFrame();
+    }
+
+    SDL_RenderPresent( gRenderer );
+
+    //Start counting the next frame
+    gLastFrameCounters = gRenderCounters;
+    gRenderCounters = LRenderCounters{ 0, 0 };
+}
+
+void resetRenderTarget()
+{
+    if( gRenderRecorder.isRecording() )
+    {
+        gRenderRecorder.recordSetTarget( 0 );
+    }
+
+    //Draw to the screen and cull against it
+    SDL_SetRenderTarget( gRenderer, nullptr );
+    gRenderTarget = nullptr;
+    updateCullRect();
+}
+
+void updateCullRect()
+{
+    //The tiled backend always covers the whole framebuffer
+    if( gTileRenderer.isEnabled() )
+    {
+        gCullRect = SDL_FRect{ 0.f, 0.f, static_cast<float>( kScreenWidth ), static_cast<float>( kScreenHeight ) };
+        return;
+    }
+
+    //Draw coordinates are relative to the viewport
+    SDL_Rect viewport{ 0, 0, kScreenWidth, kScreenHeight };
+    SDL_GetRenderViewport( gRenderer, &viewport );
+    SDL_Rect visible{ 0, 0, viewport.w, viewport.h };
+
+    //Clip rect is relative to the viewport too
+    if( SDL_RenderClipEnabled( gRenderer ) )
+    {
+        SDL_Rect clip{ 0, 0, 0, 0 };
+        SDL_GetRenderClipRect( gRenderer, &clip );
+        if( SDL_GetRectIntersection( &visible, &clip, &visible ) == false )
+        {
+            visible = SDL_Rect{ 0, 0, 0, 0 };
+        }
+    }
+
+    gCullRect = SDL_FRect{ static_cast<float>( visible.x ), static_cast<float>( visible.y ), static_cast<float>( visible.w ), static_cast<float>( visible.h ) };
+}
+
+bool isOffscreen( const SDL_FRect& dstRect, double degrees, const SDL_FPoint* center )
+{
+    //Unrotated draws cover their destination rectangle
+    float minX{ dstRect.x }, minY{ dstRect.y }, maxX{ dstRect.x + dstRect.w }, maxY{ dstRect.y + dstRect.h };
+
+    //Rotated draws stay inside the circle through the corner farthest from the pivot
+    if( degrees != 0.0 )
+    {
+        float pivotX{ center != nullptr ? center->x : dstRect.w / 2.f };
+        float pivotY{ center != nullptr ? center->y : dstRect.h / 2.f };
+        float reachX{ SDL_max( pivotX, dstRect.w - pivotX ) }, reachY{ SDL_max( pivotY, dstRect.h - pivotY ) };
+        float radius{ SDL_sqrtf( reachX * reachX + reachY * reachY ) };
+        minX = dstRect.x + pivotX - radius;
+        minY = dstRect.y + pivotY - radius;
+        maxX = dstRect.x + pivotX + radius;
+        maxY = dstRect.y + pivotY + radius;
+    }
+
+    return maxX <= gCullRect.x || maxY <= gCullRect.y || minX >= gCullRect.x + gCullRect.w || minY >= gCullRect.y + gCullRect.h;
+}
+
+Uint32 mulDiv255( Uint32 a, Uint32 b )
+{
+    Uint32 x{ a * b + 1 };
+    x += x >> 8;
+    return x >> 8;
+}
+
+void blendSpan( Uint32* dst, const Uint32* src, int count, SDL_Color colorMod, SDL_BlendMode blendMode )
+{
+    #if defined(LAZYFOO_X86_SIMD)
+    //Only blend, premultiplied blend, add and multiply have vector kernels
+    if( blendMode == SDL_BLENDMODE_BLEND || blendMode == SDL_BLENDMODE_BLEND_PREMULTIPLIED || blendMode == SDL_BLENDMODE_ADD || blendMode == SDL_BLENDMODE_MUL )
+    {
+        if( gBlendKernel == eBlendKernel::AVX2 )
+        {
+            blendSpanAVX2( dst, src, count, colorMod, blendMode );
+            return;
+        }
+        else if( gBlendKernel == eBlendKernel::SSE2 )
+        {
+            blendSpanSSE2( dst, src, count, colorMod, blendMode );
+            return;
+        }
+    }
+    #endif
+
+    blendSpanScalar( dst, src, count, colorMod, blendMode );
+}
+
+void blendSpanScalar( Uint32* dst, const Uint32* src, int count, SDL_Color colorMod, SDL_BlendMode blendMode )
+{
+    for( int i = 0; i < count; ++i )
+    {
+        //Unpack and modulate source
+        Uint32 srcA{ src[ i ] >> 24 }, srcR{ ( src[ i ] >> 16 ) & 0xFF }, srcG{ ( src[ i ] >> 8 ) & 0xFF }, srcB{ src[ i ] & 0xFF };
+        if( colorMod.r != 0xFF || colorMod.g != 0xFF || colorMod.b != 0xFF )
+        {
+            srcR = mulDiv255( srcR, colorMod.r );
+            srcG = mulDiv255( srcG, colorMod.g );
+            srcB = mulDiv255( srcB, colorMod.b );
+        }
+        if( colorMod.a != 0xFF )
+        {
+            srcA = mulDiv255( srcA, colorMod.a );
+        }
+
+        //Straight alpha modes weight the source by its alpha first
+        if( ( blendMode == SDL_BLENDMODE_BLEND || blendMode == SDL_BLENDMODE_ADD ) && srcA < 0xFF )
+        {
+            srcR = mulDiv255( srcR, srcA );
+            srcG = mulDiv255( srcG, srcA );
+            srcB = mulDiv255( srcB, srcA );
+        }
+
+        //Unpack destination
+        Uint32 dstA{ dst[ i ] >> 24 }, dstR{ ( dst[ i ] >> 16 ) & 0xFF }, dstG{ ( dst[ i ] >> 8 ) & 0xFF }, dstB{ dst[ i ] & 0xFF };
+        switch( blendMode )
+        {
+            case SDL_BLENDMODE_NONE:
+                dstA = srcA; dstR = srcR; dstG = srcG; dstB = srcB;
+                break;
+
+            case SDL_BLENDMODE_BLEND:
+            case SDL_BLENDMODE_BLEND_PREMULTIPLIED:
+                dstR = SDL_min( srcR + mulDiv255( 0xFF - srcA, dstR ), 0xFFu );
+                dstG = SDL_min( srcG + mulDiv255( 0xFF - srcA, dstG ), 0xFFu );
+                dstB = SDL_min( srcB + mulDiv255( 0xFF - srcA, dstB ), 0xFFu );
+                dstA = SDL_min( srcA + mulDiv255( 0xFF - srcA, dstA ), 0xFFu );
+                break;
+
+            case SDL_BLENDMODE_ADD:
+            case SDL_BLENDMODE_ADD_PREMULTIPLIED:
+                dstR = SDL_min( srcR + dstR, 0xFFu );
+                dstG = SDL_min( srcG + dstG, 0xFFu );
+                dstB = SDL_min( srcB + dstB, 0xFFu );
+                break;
+
+            case SDL_BLENDMODE_MOD:
+                dstR = mulDiv255( srcR, dstR );
+                dstG = mulDiv255( srcG, dstG );
+                dstB = mulDiv255( srcB, dstB );
+                break;
+
+            case SDL_BLENDMODE_MUL:
+                dstR = SDL_min( mulDiv255( srcR, dstR ) + mulDiv255( dstR, 0xFF - srcA ), 0xFFu );
+                dstG = SDL_min( mulDiv255( srcG, dstG ) + mulDiv255( dstG, 0xFF - srcA ), 0xFFu );
+                dstB = SDL_min( mulDiv255( srcB, dstB ) + mulDiv255( dstB, 0xFF - srcA ), 0xFFu );
+                break;
+
+            default:
+            {
+                //Unknown modes leave the destination as it is, report it once across tile workers
+                static SDL_AtomicInt reportedUnknownMode{ 0 };
+                if( SDL_CompareAndSwapAtomicInt( &reportedUnknownMode, 0, 1 ) )
+                {
+                    SDL_Log( "Blend mode %u is not supported by the software blender!\n", blendMode );
+                }
+                break;
             }
         }
+
+        dst[ i ] = ( dstA << 24 ) | ( dstR << 16 ) | ( dstG << 8 ) | dstB;
     }
+}
 
-    return success;
+#if defined(LAZYFOO_X86_SIMD)
+//Divides 16 bit products by 255 the same way as mulDiv255
+LAZYFOO_TARGET_SSE2 static inline __m128i mulDiv255SSE2( __m128i a, __m128i b )
+{
+    __m128i x{ _mm_add_epi16( _mm_mullo_epi16( a, b ), _mm_set1_epi16( 1 ) ) };
+    x = _mm_add_epi16( x, _mm_srli_epi16( x, 8 ) );
+    return _mm_srli_epi16( x, 8 );
 }
 
+//Blends two pixels widened to 16 bits per channel
+LAZYFOO_TARGET_SSE2 static inline __m128i blendPixelsSSE2( __m128i src, __m128i dst, __m128i modulate, SDL_BlendMode blendMode )
+{
+    const __m128i kMax{ _mm_set1_epi16( 0xFF ) };
+    const __m128i kAlphaLanes{ _mm_set_epi16( 0xFF, 0, 0, 0, 0xFF, 0, 0, 0 ) };
+    const __m128i kColorLanes{ _mm_set_epi16( 0, -1, -1, -1, 0, -1, -1, -1 ) };
+
+    //Modulate, multiplying by 255 leaves channels unchanged
+    src = mulDiv255SSE2( src, modulate );
 
-bool loadMedia()
+    //Spread each pixel's alpha over its channels
+    __m128i alpha{ _mm_shufflehi_epi16( _mm_shufflelo_epi16( src, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 3, 3, 3, 3 ) ) };
+    __m128i inverseAlpha{ _mm_sub_epi16( kMax, alpha ) };
+
+    __m128i result;
+    if( blendMode == SDL_BLENDMODE_MUL )
+    {
+        //Color is src * dst + dst * ( 1 - srcA ), alpha is kept
+        __m128i color{ _mm_min_epi16( _mm_add_epi16( mulDiv255SSE2( src, dst ), mulDiv255SSE2( dst, inverseAlpha ) ), kMax ) };
+        result = _mm_or_si128( _mm_and_si128( color, kColorLanes ), _mm_and_si128( dst, kAlphaLanes ) );
+    }
+    else
+    {
+        //Weight straight color by alpha, alpha lanes multiply by 255
+        if( blendMode != SDL_BLENDMODE_BLEND_PREMULTIPLIED )
+        {
+            src = mulDiv255SSE2( src, _mm_or_si128( _mm_and_si128( alpha, kColorLanes ), kAlphaLanes ) );
+        }
+
+        if( blendMode == SDL_BLENDMODE_ADD )
+        {
+            //Color is src + dst, alpha is kept
+            __m128i color{ _mm_min_epi16( _mm_add_epi16( src, dst ), kMax ) };
+            result = _mm_or_si128( _mm_and_si128( color, kColorLanes ), _mm_and_si128( dst, kAlphaLanes ) );
+        }
+        else
+        {
+            //Everything is src + dst * ( 1 - srcA )
+            result = _mm_min_epi16( _mm_add_epi16( src, mulDiv255SSE2( dst, inverseAlpha ) ), kMax );
+        }
+    }
+
+    return result;
+}
+
+LAZYFOO_TARGET_SSE2 void blendSpanSSE2( Uint32* dst, const Uint32* src, int count, SDL_Color colorMod, SDL_BlendMode blendMode )
 {
-    //File loading flag
-    bool success{ true };
+    const __m128i zero{ _mm_setzero_si128() };
+    const __m128i modulate{ _mm_set_epi16( colorMod.a, colorMod.r, colorMod.g, colorMod.b, colorMod.a, colorMod.r, colorMod.g, colorMod.b ) };
 
-    
-    //Load scene font
-    // std::string fontPath{ "12-frame-rate-and-vsync/lazy.ttf" };
-    // if( gFont = TTF_OpenFont( fontPath.c_str(), 28 ); gFont == nullptr )
-    // {
-    //     SDL_Log( "Could not load %s! SDL_ttf Error: %s\n", fontPath.c_str(), SDL_GetError() );
-    //     success = false;
-    // }
-    // else
-    // {
-    //     //Load text
-    //     SDL_Color textColor{ 0x00, 0x00, 0x00, 0xFF };
-    //     if( gFpsTexture.loadFromRenderedText( "The quick brown fox jumps over the lazy dog", textColor ) == false )
-    //     {
-    //         SDL_Log( "Could not load text texture %s! SDL_ttf Error: %s\n", fontPath.c_str(), SDL_GetError() );
-    //         success = false;
-    //     }
-    // }
+    //Four pixels at a time
+    int i{ 0 };
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128i srcPixels{ _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ) };
+        __m128i dstPixels{ _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst + i ) ) };
 
-    //Load scene images
-    if( gSpriteSheetTexture.loadFromFile( "14-animation/foo-sprites.png" ) == false )
+        __m128i low{ blendPixelsSSE2( _mm_unpacklo_epi8( srcPixels, zero ), _mm_unpacklo_epi8( dstPixels, zero ), modulate, blendMode ) };
+        __m128i high{ blendPixelsSSE2( _mm_unpackhi_epi8( srcPixels, zero ), _mm_unpackhi_epi8( dstPixels, zero ), modulate, blendMode ) };
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( low, high ) );
+    }
+
+    //Finish the tail one pixel at a time
+    blendSpanScalar( dst + i, src + i, count - i, colorMod, blendMode );
+}
+
+//Divides 16 bit products by 255 the same way as mulDiv255
+LAZYFOO_TARGET_AVX2 static inline __m256i mulDiv255AVX2( __m256i a, __m256i b )
+{
+    __m256i x{ _mm256_add_epi16( _mm256_mullo_epi16( a, b ), _mm256_set1_epi16( 1 ) ) };
+    x = _mm256_add_epi16( x, _mm256_srli_epi16( x, 8 ) );
+    return _mm256_srli_epi16( x, 8 );
+}
+
+//Blends four pixels widened to 16 bits per channel
+LAZYFOO_TARGET_AVX2 static inline __m256i blendPixelsAVX2( __m256i src, __m256i dst, __m256i modulate, SDL_BlendMode blendMode )
+{
+    const __m256i kMax{ _mm256_set1_epi16( 0xFF ) };
+    const __m256i kAlphaLanes{ _mm256_set_epi16( 0xFF, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF, 0, 0, 0 ) };
+    const __m256i kColorLanes{ _mm256_set_epi16( 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1 ) };
+
+    src = mulDiv255AVX2( src, modulate );
+
+    __m256i alpha{ _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( src, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 3, 3, 3, 3 ) ) };
+    __m256i inverseAlpha{ _mm256_sub_epi16( kMax, alpha ) };
+
+    __m256i result;
+    if( blendMode == SDL_BLENDMODE_MUL )
     {
-        SDL_Log( "Unable to load foo image!\n");
-        success = false;
+        __m256i color{ _mm256_min_epi16( _mm256_add_epi16( mulDiv255AVX2( src, dst ), mulDiv255AVX2( dst, inverseAlpha ) ), kMax ) };
+        result = _mm256_or_si256( _mm256_and_si256( color, kColorLanes ), _mm256_and_si256( dst, kAlphaLanes ) );
+    }
+    else
+    {
+        if( blendMode != SDL_BLENDMODE_BLEND_PREMULTIPLIED )
+        {
+            src = mulDiv255AVX2( src, _mm256_or_si256( _mm256_and_si256( alpha, kColorLanes ), kAlphaLanes ) );
+        }
+
+        if( blendMode == SDL_BLENDMODE_ADD )
+        {
+            __m256i color{ _mm256_min_epi16( _mm256_add_epi16( src, dst ), kMax ) };
+            result = _mm256_or_si256( _mm256_and_si256( color, kColorLanes ), _mm256_and_si256( dst, kAlphaLanes ) );
+        }
+        else
+        {
+            result = _mm256_min_epi16( _mm256_add_epi16( src, mulDiv255AVX2( dst, inverseAlpha ) ), kMax );
+        }
+    }
+
+    return result;
+}
+
+LAZYFOO_TARGET_AVX2 void blendSpanAVX2( Uint32* dst, const Uint32* src, int count, SDL_Color colorMod, SDL_BlendMode blendMode )
+{
+    const __m256i zero{ _mm256_setzero_si256() };
+    const __m256i modulate{ _mm256_set_epi16( colorMod.a, colorMod.r, colorMod.g, colorMod.b, colorMod.a, colorMod.r, colorMod.g, colorMod.b,
+                                              colorMod.a, colorMod.r, colorMod.g, colorMod.b, colorMod.a, colorMod.r, colorMod.g, colorMod.b ) };
+
+    //Eight pixels at a time, unpacking and packing stay within 128 bit lanes so order is kept
+    int i{ 0 };
+    for( ; i + 8 <= count; i += 8 )
+    {
+        __m256i srcPixels{ _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + i ) ) };
+        __m256i dstPixels{ _mm256_loadu_si256( reinterpret_cast<const __m256i*>( dst + i ) ) };
+
+        __m256i low{ blendPixelsAVX2( _mm256_unpacklo_epi8( srcPixels, zero ), _mm256_unpacklo_epi8( dstPixels, zero ), modulate, blendMode ) };
+        __m256i high{ blendPixelsAVX2( _mm256_unpackhi_epi8( srcPixels, zero ), _mm256_unpackhi_epi8( dstPixels, zero ), modulate, blendMode ) };
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), _mm256_packus_epi16( low, high ) );
+    }
+
+    //Finish with the narrower kernel
+    blendSpanSSE2( dst + i, src + i, count - i, colorMod, blendMode );
+}
+#endif
+
+void selectBlendKernel()
+{
+    //Use the widest kernel the CPU has
+    gBlendKernel = eBlendKernel::Scalar;
+    #if defined(LAZYFOO_X86_SIMD)
+    if( SDL_HasAVX2() )
+    {
+        gBlendKernel = eBlendKernel::AVX2;
+    }
+    else if( SDL_HasSSE2() )
+    {
+        gBlendKernel = eBlendKernel::SSE2;
+    }
+    #endif
+
+    //Allow forcing a narrower kernel for comparisons
+    constexpr const char* kKernelNames[] = { "scalar", "sse2", "avx2" };
+    if( gBlendKernelName != nullptr )
+    {
+        //Find the requested kernel
+        int requested{ -1 };
+        for( int kernel = 0; kernel < static_cast<int>( SDL_arraysize( kKernelNames ) ); ++kernel )
+        {
+            if( SDL_strcmp( gBlendKernelName, kKernelNames[ kernel ] ) == 0 )
+            {
+                requested = kernel;
+            }
+        }
+
+        //Kernels wider than the CPU supports can't be forced
+        if( requested < 0 )
+        {
+            SDL_Log( "Unknown blend kernel %s, expected scalar, sse2 or avx2\n", gBlendKernelName );
+        }
+        else if( requested > static_cast<int>( gBlendKernel ) )
+        {
+            SDL_Log( "Blend kernel %s is not supported on this CPU\n", gBlendKernelName );
+        }
+        else
+        {
+            gBlendKernel = static_cast<eBlendKernel>( requested );
+        }
+    }
+    SDL_Log( "Using %s blend kernel\n", kKernelNames[ static_cast<int>( gBlendKernel ) ] );
+}
+
+bool validateBlendKernels()
+{
+    //Test image size
+    constexpr int kSize = 256;
+
+    //Modes with vector kernels and the modulations to try
+    constexpr SDL_BlendMode kBlendModes[] = { SDL_BLENDMODE_BLEND, SDL_BLENDMODE_BLEND_PREMULTIPLIED, SDL_BLENDMODE_ADD, SDL_BLENDMODE_MUL };
+    constexpr SDL_Color kColorMods[] = { { 0xFF, 0xFF, 0xFF, 0xFF }, { 0x7F, 0xFF, 0x00, 0xFF }, { 0xFF, 0xFF, 0xFF, 0x7F }, { 0x30, 0xC0, 0x7F, 0x40 } };
+
+    //Fill source and destination with noise covering every alpha
+    SDL_Surface* source{ SDL_CreateSurface( kSize, kSize, SDL_PIXELFORMAT_ARGB8888 ) };
+    SDL_Surface* background{ SDL_CreateSurface( kSize, kSize, SDL_PIXELFORMAT_ARGB8888 ) };
+    SDL_Surface* expected{ SDL_CreateSurface( kSize, kSize, SDL_PIXELFORMAT_ARGB8888 ) };
+    if( source == nullptr || background == nullptr || expected == nullptr )
+    {
+        SDL_Log( "Unable to create blend test surfaces! SDL error: %s\n", SDL_GetError() );
+        SDL_DestroySurface( source );
+        SDL_DestroySurface( background );
+        SDL_DestroySurface( expected );
+        return false;
+    }
+
+    Uint32 seed{ 0x12345678 };
+    for( int i = 0; i < kSize * kSize; ++i )
+    {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        static_cast<Uint32*>( source->pixels )[ i ] = seed;
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        static_cast<Uint32*>( background->pixels )[ i ] = seed;
+    }
+
+    //Kernels to check on this CPU
+    std::vector<eBlendKernel> kernels{ eBlendKernel::Scalar };
+    #if defined(LAZYFOO_X86_SIMD)
+    if( SDL_HasSSE2() )
+    {
+        kernels.push_back( eBlendKernel::SSE2 );
+    }
+    if( SDL_HasAVX2() )
+    {
+        kernels.push_back( eBlendKernel::AVX2 );
+    }
+    #endif
+
+    bool success{ true };
+    std::vector<Uint32> actual( static_cast<size_t>( kSize ) * kSize );
+    const eBlendKernel selectedKernel{ gBlendKernel };
+    for( SDL_BlendMode blendMode : kBlendModes )
+    {
+        for( const SDL_Color& colorMod : kColorMods )
+        {
+            //Let SDL blit the reference image
+            SDL_BlitSurface( background, nullptr, expected, nullptr );
+            SDL_SetSurfaceColorMod( source, colorMod.r, colorMod.g, colorMod.b );
+            SDL_SetSurfaceAlphaMod( source, colorMod.a );
+            SDL_SetSurfaceBlendMode( source, blendMode );
+            SDL_BlitSurface( source, nullptr, expected, nullptr );
+            SDL_SetSurfaceBlendMode( source, SDL_BLENDMODE_NONE );
+
+            for( eBlendKernel kernel : kernels )
+            {
+                //Blend row by row like the rasterizer does
+                gBlendKernel = kernel;
+                for( int y = 0; y < kSize; ++y )
+                {
+                    Uint32* dstRow{ &actual[ static_cast<size_t>( y ) * kSize ] };
+                    std::copy_n( reinterpret_cast<const Uint32*>( static_cast<const Uint8*>( background->pixels ) + y * background->pitch ), kSize, dstRow );
+                    blendSpan( dstRow, reinterpret_cast<const Uint32*>( static_cast<const Uint8*>( source->pixels ) + y * source->pitch ), kSize, colorMod, blendMode );
+                }
+
+                //Count differing pixels
+                int mismatches{ 0 };
+                for( int y = 0; y < kSize; ++y )
+                {
+                    const Uint32* expectedRow{ reinterpret_cast<const Uint32*>( static_cast<const Uint8*>( expected->pixels ) + y * expected->pitch ) };
+                    for( int x = 0; x < kSize; ++x )
+                    {
+                        if( actual[ static_cast<size_t>( y ) * kSize + x ] != expectedRow[ x ] )
+                        {
+                            if( mismatches == 0 )
+                            {
+                                SDL_Log( "First mismatch at %d,%d: got %08X expected %08X\n", x, y, actual[ static_cast<size_t>( y ) * kSize + x ], expectedRow[ x ] );
+                            }
+                            mismatches++;
+                        }
+                    }
+                }
+
+                SDL_Log( "Blend kernel %d mode %u mod %02X%02X%02X%02X: %s (%d mismatches)\n",
+                    static_cast<int>( kernel ), blendMode, colorMod.r, colorMod.g, colorMod.b, colorMod.a, mismatches == 0 ? "exact" : "FAILED", mismatches );
+                if( mismatches != 0 )
+                {
+                    success = false;
+                }
+            }
+        }
     }
+    gBlendKernel = selectedKernel;
+
+    //Clean up
+    SDL_DestroySurface( source );
+    SDL_DestroySurface( background );
+    SDL_DestroySurface( expected );
 
     return success;
 }
 
+void runBlendBenchmark()
+{
+    //One megapixel blended per pass
+    constexpr int kMegapixel = 1024 * 1024;
+    constexpr int kPasses = 64;
+    constexpr SDL_BlendMode kBlendModes[] = { SDL_BLENDMODE_BLEND, SDL_BLENDMODE_BLEND_PREMULTIPLIED, SDL_BLENDMODE_ADD, SDL_BLENDMODE_MUL };
+    constexpr const char* kBlendModeNames[] = { "blend", "premul", "add", "mul" };
+    constexpr const char* kKernelNames[] = { "scalar", "sse2", "avx2" };
+    constexpr SDL_Color kColorMod{ 0xC0, 0x80, 0xFF, 0xA0 };
+
+    //Fill buffers with noise
+    std::vector<Uint32> source( kMegapixel ), destination( kMegapixel );
+    Uint32 seed{ 0x9E3779B9 };
+    for( int i = 0; i < kMegapixel; ++i )
+    {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        source[ i ] = seed;
+        destination[ i ] = ~seed;
+    }
 
-void close()
+    const eBlendKernel selectedKernel{ gBlendKernel };
+    for( int kernel = static_cast<int>( eBlendKernel::Scalar ); kernel <= static_cast<int>( selectedKernel ); ++kernel )
+    {
+        gBlendKernel = static_cast<eBlendKernel>( kernel );
+        for( int mode = 0; mode < static_cast<int>( SDL_arraysize( kBlendModes ) ); ++mode )
+        {
+            //Blend in framebuffer sized rows
+            LTimer passTimer{ &gRealClock };
+            passTimer.start();
+            for( int pass = 0; pass < kPasses; ++pass )
+            {
+                for( int offset = 0; offset < kMegapixel; offset += kScreenWidth )
+                {
+                    blendSpan( &destination[ offset ], &source[ offset ], SDL_min( kScreenWidth, kMegapixel - offset ), kColorMod, kBlendModes[ mode ] );
+                }
+            }
+
+            double msPerMegapixel{ static_cast<double>( passTimer.getTicksNS() ) / 1000000.0 / kPasses };
+            SDL_Log( "Blend %-6s %-6s %.3f ms/megapixel\n", kKernelNames[ kernel ], kBlendModeNames[ mode ], msPerMegapixel );
+        }
+    }
+    gBlendKernel = selectedKernel;
+}
+
+void runTileScalingBenchmark()
 {
-    //Clean up texture
-    gSpriteSheetTexture.destroy();
+    //Sprite sheet frame size
+    constexpr float kSpriteWidth = 64;
+    constexpr float kSpriteHeight = 205;
+    constexpr int kSpriteFrames = 4;
 
-    //Free font
-    TTF_CloseFont( gFont );
-    gFont = nullptr;
+    //Draws per frame
+    constexpr int kDrawCount = 256;
 
-    //Clean up button
-    // gFpsTexture.destroy();
+    //Blend modes cycled through the draws
+    constexpr SDL_BlendMode kBlendModes[] = { SDL_BLENDMODE_BLEND, SDL_BLENDMODE_ADD, SDL_BLENDMODE_MUL, SDL_BLENDMODE_NONE };
 
-    //Destroy window
-    SDL_DestroyRenderer( gRenderer );
-    gRenderer = nullptr;
-    SDL_DestroyWindow( gWindow );
-    gWindow = nullptr;
+    double singleThreadMs{ 0.0 };
+    const int maxThreads{ SDL_GetNumLogicalCPUCores() };
+    for( int threads = 1; threads <= maxThreads; ++threads )
+    {
+        //Restart the backend with this many threads
+        if( gTileRenderer.init( kScreenWidth, kScreenHeight, threads ) == false )
+        {
+            break;
+        }
 
-    //Quit SDL subsystems
-    TTF_Quit();
-    SDL_Quit();
+        LTimer runTimer{ &gRealClock };
+        runTimer.start();
+        for( int frame = 0; frame < gBenchmarkFrames; ++frame )
+        {
+            renderClear( 0xFF, 0xFF, 0xFF, 0xFF );
+
+            //Scatter scaled, modulated and blended sprites over the screen
+            for( int i = 0; i < kDrawCount; ++i )
+            {
+                SDL_FRect clip{ kSpriteWidth * ( ( i + frame ) % kSpriteFrames ), 0.f, kSpriteWidth, kSpriteHeight };
+                float scale{ 0.25f + 0.25f * ( i % 5 ) };
+                float x{ static_cast<float>( ( i * 97 + frame * 3 ) % kScreenWidth ) - kSpriteWidth / 2 };
+                float y{ static_cast<float>( ( i * 61 ) % kScreenHeight ) - kSpriteHeight / 2 };
+
+                gSpriteSheetTexture.setColor( static_cast<Uint8>( 0xFF - i ), static_cast<Uint8>( i * 3 ), 0xFF );
+                gSpriteSheetTexture.setAlpha( static_cast<Uint8>( 0x80 + i / 2 ) );
+                gSpriteSheetTexture.setBlending( kBlendModes[ i % SDL_arraysize( kBlendModes ) ] );
+                gSpriteSheetTexture.render( x, y, &clip, kSpriteWidth * scale, kSpriteHeight * scale );
+            }
+
+            gTileRenderer.flush();
+        }
+
+        //Report average frame time and speedup
+        double frameMs{ static_cast<double>( runTimer.getTicksNS() ) / 1000000.0 / gBenchmarkFrames };
+        if( threads == 1 )
+        {
+            singleThreadMs = frameMs;
+        }
+        SDL_Log( "Tiled raster: %2d threads %.3f ms/frame (%.2fx)\n", threads, frameMs, singleThreadMs / frameMs );
+    }
+
+    //Restore texture state
+    gSpriteSheetTexture.setColor( 0xFF, 0xFF, 0xFF );
+    gSpriteSheetTexture.setAlpha( 0xFF );
+    gSpriteSheetTexture.setBlending( SDL_BLENDMODE_BLEND );
 }
 
 
@@ -717,6 +4228,9 @@ int main( int argc, char* args[] )
     //Final exit code
     int exitCode{ 0 };
 
+    //Read run options
+    parseArguments( argc, args );
+
     //Initialize
     if( init() == false )
     {
@@ -731,6 +4245,32 @@ int main( int argc, char* args[] )
             SDL_Log( "Unable to load media!\n" );
             exitCode = 2;
         }
+        else if( gTileBenchmark )
+        {
+            //Time the tiled backend instead of running the scene
+            runTileScalingBenchmark();
+        }
+        else if( gReplayPath != nullptr )
+        {
+            //Replay a render log instead of running the scene
+            LRenderReplayer replayer;
+            if( replayer.load( gReplayPath ) == false || replayer.replay() == false )
+            {
+                exitCode = 4;
+            }
+        }
+        else if( gBlendValidate || gBlendBenchmark )
+        {
+            //Check and time the blend kernels instead of running the scene
+            if( gBlendValidate && validateBlendKernels() == false )
+            {
+                exitCode = 3;
+            }
+            if( gBlendBenchmark )
+            {
+                runBlendBenchmark();
+            }
+        }
         else
         {
             //The quit flag
@@ -741,13 +4281,13 @@ int main( int argc, char* args[] )
             SDL_zero( e );
 
              //VSync toggle
-            bool vsyncEnabled{ true };
+            bool vsyncEnabled{ !gHeadless };
 
             //FPS cap toggle
             bool fpsCapEnabled{ false };
 
-            //Timer to cap frame rate
-            LTimer capTimer;
+            //Timer for the real time each frame takes
+            LTimer capTimer{ &gRealClock };
 
             //Current animation frame
             int frame{ -1 };
@@ -767,6 +4307,20 @@ int main( int argc, char* args[] )
             //Flipmode
             SDL_FlipMode flipMode = SDL_FLIP_NONE;
 
+            //Tilemap camera position
+            float cameraX{ 0.f }, cameraY{ 0.f };
+
+            //Headless frame timing
+            LFrameBenchmark benchmark;
+            if( gHeadless )
+            {
+                benchmark.start();
+            }
+
+            //Windowed frame deadlines
+            LFramePacer framePacer;
+            framePacer.start( 1000000000 / kScreenFps, gFramePacing );
+
             // //Place buttons
             // constexpr int kButtonCount = 4;
             // LButton buttons[ kButtonCount ];
@@ -852,28 +4406,78 @@ int main( int argc, char* args[] )
                 //Update dot
                 // dot.move();
 
+                //Draw the scene offscreen at the current scale
+                if( gDynamicResolution.isEnabled() )
+                {
+                    gDynamicResolution.beginFrame();
+                }
+
                 //Fill the background
-                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF,  0xFF );
-                SDL_RenderClear( gRenderer );
+                renderClear( 0xFF, 0xFF, 0xFF, 0xFF );
 
                 //Render dot
                 // dot.render();
 
+                //Scroll the map behind the sprite
+                if( gTilemapScene )
+                {
+                    cameraX += 3.f;
+                    cameraY += 2.f;
+                    if( cameraX > gTilemap.getPixelWidth() - kScreenWidth )
+                    {
+                        cameraX = 0.f;
+                    }
+                    if( cameraY > gTilemap.getPixelHeight() - kScreenHeight )
+                    {
+                        cameraY = 0.f;
+                    }
+                    gTilemap.render( cameraX, cameraY );
+                }
+
                 //Render current frame
                 SDL_FRect* currentClip{ &spriteClips[ frame / kWakingAnimationFramesPerSprite ] };
                 gSpriteSheetTexture.render( ( kScreenWidth - kSpriteWidth ) / 2, ( kScreenHeight - kSpriteHeight ) / 2, currentClip );
 
                 
 
+                //Upscale the scene and adapt to how long it took before presenting can block on VSync
+                if( gDynamicResolution.isEnabled() )
+                {
+                    //SDL batches draws until present, so run them now to time what they cost
+                    gDynamicResolution.endFrame();
+                    SDL_FlushRenderer( gRenderer );
+                    gDynamicResolution.update( capTimer.getTicksNS() );
+                }
+
                 //Update screen
-                SDL_RenderPresent(gRenderer);
+                renderPresent();
 
-                //If time remaining in frame
-                constexpr Uint64 nsPerFrame = 1000000000 / kScreenFps; 
+                //Frame time before waiting
                 Uint64 frameNs{ capTimer.getTicksNS() };
-                if ( frameNs < nsPerFrame)
+                if( gHeadless )
+                {
+                    //Record the uncapped frame and stop after the requested count
+                    benchmark.addFrame( frameNs, gLastFrameCounters );
+                    if( benchmark.getFrameCount() >= gBenchmarkFrames )
+                    {
+                        quit = true;
+                    }
+
+                    //Move virtual time a frame ahead so timed logic runs as if paced, without sleeping
+                    if( gClock->isVirtual() )
+                    {
+                        framePacer.wait();
+                    }
+                }
+                else
                 {
-                    SDL_DelayNS(nsPerFrame - frameNs);
+                    //Wait for the frame deadline and log jitter every time the statistics window fills
+                    framePacer.wait();
+                    if( framePacer.getSampleCount() == LFramePacer::kJitterSamples )
+                    {
+                        framePacer.report();
+                        framePacer.clearStatistics();
+                    }
                 }
 
                 //Fill the background
@@ -893,6 +4497,12 @@ int main( int argc, char* args[] )
                 //Update screen
                 // SDL_RenderPresent( gRenderer );
             } 
+
+            //Print headless results
+            if( gHeadless )
+            {
+                benchmark.report();
+            }
         }
     }
 
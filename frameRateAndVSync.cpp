@@ -8,6 +8,7 @@
 #include <SDL3_ttf/SDL_ttf.h>
 #include <string>
 #include <sstream>
+#include <algorithm>
 
 /* Constants */
 //Screen dimension constants
@@ -26,11 +27,61 @@ bool loadMedia();
 //Frees media and shuts down SDL
 void close();
 
-class LTimer
+class LClock
+{
+    public:
+        //Cleans up the clock
+        virtual ~LClock() = default;
+
+        //Gets the clock's time
+        virtual Uint64 getTicksNS() = 0;
+
+        //Waits for an amount of the clock's time
+        virtual void delayNS( Uint64 ns ) = 0;
+
+        //Checks if time only moves when asked to, busy waiting on these never ends
+        virtual bool isVirtual();
+};
+
+class LRealClock : public LClock
+{
+    public:
+        //Wall clock time since SDL started
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+};
+
+class LScaledClock : public LClock
 {
     public:
         //Initializes variables
-        LTimer();
+        LScaledClock( LClock& source, double scale );
+
+        //Changes speed without making time jump
+        void setScale( double scale );
+        double getScale();
+
+        //Source time multiplied by the scale
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+
+    private:
+        //Clock being scaled
+        LClock& mSource;
+
+        //Time multiplier
+        double mScale;
+
+        //Source and scaled time when the scale last changed
+        Uint64 mSourceAnchor;
+        Uint64 mTicksAnchor;
+};
+
+class LTimer
+{
+    public:
+        //Initializes variables, timers read the global clock unless given their own
+        LTimer( LClock* clock = nullptr );
 
         //The various clock actions
         void start();
@@ -45,7 +96,13 @@ class LTimer
         bool isStarted();
         bool isPaused();
 
+        //Gets the clock the timer reads
+        LClock* getClock();
+
     private:
+        //Clock this timer always reads, null to follow the global clock
+        LClock* mClock;
+
         //The clock time when the timer started
         Uint64 mStartTicks;
 
@@ -57,6 +114,76 @@ class LTimer
         bool mStarted;
 };
 
+class LFramePacer
+{
+    public:
+        //How waits reach the deadline
+        enum class ePacing
+        {
+            Sleep,
+            Hybrid
+        };
+
+        //Number of recent frames the jitter statistics cover
+        static constexpr int kJitterSamples = 600;
+
+        //Limits for the calibrated time left to spin after sleeping
+        static constexpr Uint64 kMinSpinMarginNS = 200000;
+        static constexpr Uint64 kMaxSpinMarginNS = 4000000;
+
+        //Initializes variables
+        LFramePacer();
+
+        //Starts pacing with the first deadline one period from now
+        void start( Uint64 periodNs, ePacing pacing = ePacing::Hybrid );
+
+        //Waits for the current deadline and sets the next one
+        void wait();
+
+        //Switches how waits reach the deadline and clears statistics
+        void setPacing( ePacing pacing );
+        ePacing getPacing();
+
+        //Gets how far wakeups landed from their deadlines
+        Uint64 getMeanErrorNS();
+        Uint64 getP99ErrorNS();
+        int getSampleCount();
+
+        //Logs jitter statistics
+        void report();
+
+        //Starts a new statistics window
+        void clearStatistics();
+
+        //Gets how long the last wait spun
+        Uint64 getLastSpinNS();
+
+    private:
+        //Stores the wakeup error for a frame
+        void addSample( Uint64 errorNs );
+
+        //Clock deadlines are measured on
+        LTimer mClock;
+
+        //Frame period and the absolute time of the next deadline
+        Uint64 mPeriodNs;
+        Uint64 mDeadlineNs;
+
+        //Time before the deadline when sleeping stops, grows with observed oversleep
+        Uint64 mSpinMarginNs;
+
+        //How waits reach the deadline
+        ePacing mPacing;
+
+        //Time the last wait spent spinning
+        Uint64 mLastSpinNs;
+
+        //Recent wakeup errors
+        Uint64 mErrors[ kJitterSamples ];
+        int mErrorCount;
+        int mNextError;
+};
+
 
 class LButton
 {
@@ -146,6 +273,206 @@ private:
     int mHeight;
 };
 
+class LTextAtlas
+{
+    public:
+        //Printable ASCII range kept in the atlas
+        static constexpr char kFirstGlyph = ' ';
+        static constexpr char kLastGlyph = '~';
+        static constexpr int kGlyphCount = kLastGlyph - kFirstGlyph + 1;
+
+        //Initializes variables
+        LTextAtlas();
+
+        //Rasterizes every glyph once with the global font
+        bool init( SDL_Color textColor );
+
+        //Frees the atlas
+        void destroy();
+
+        //Gets the size text would draw at
+        float getTextWidth( const char* text, float scale = 1.f );
+        float getLineHeight( float scale = 1.f );
+
+        //Draws text by copying glyphs out of the atlas
+        void render( float x, float y, const char* text, float scale = 1.f );
+
+    private:
+        //All glyphs on one line
+        LTexture mGlyphs;
+
+        //Where each glyph sits in the atlas
+        SDL_FRect mGlyphClips[ kGlyphCount ];
+};
+
+//Parts of a frame timed separately
+enum class eFramePhase
+{
+    Events = 0,
+    Update = 1,
+    Render = 2,
+    Present = 3,
+    Sleep = 4,
+    Count = 5
+};
+
+//Time spent in each phase of one frame
+struct LFrameRecord
+{
+    Uint64 phaseNs[ static_cast<int>( eFramePhase::Count ) ];
+    Uint64 totalNs;
+};
+
+//Rolling statistics over the recorded frames
+struct LFrameSummary
+{
+    int frameCount;
+    Uint64 p50Ns;
+    Uint64 p95Ns;
+    Uint64 p99Ns;
+    Uint64 maxNs;
+    Uint64 phaseMeanNs[ static_cast<int>( eFramePhase::Count ) ];
+};
+
+class LFrameStats
+{
+    public:
+        //Frames kept, power of two so the ring index is a mask
+        static constexpr int kCapacity = 256;
+
+        //Histogram covers 0 to 32ms in 1ms buckets, the last bucket also holds slower frames
+        static constexpr int kHistogramBuckets = 32;
+        static constexpr Uint64 kHistogramBucketNs = 1000000;
+
+        //On screen graph height in pixels, covering two frame budgets
+        static constexpr float kGraphHeight = 96.f;
+
+        //Notes kept about decisions made from the statistics
+        static constexpr int kNoteCount = 8;
+        static constexpr int kNoteLength = 160;
+
+        //Initializes variables
+        LFrameStats();
+
+        //Starts timing a frame
+        void beginFrame();
+
+        //Charges the time since the last mark to a phase
+        void mark( eFramePhase phase );
+
+        //Publishes the finished frame to the ring
+        void endFrame();
+
+        //Copies the recorded frames oldest first, safe to call from any thread, returns the count
+        int snapshot( LFrameRecord* records );
+
+        //Computes percentiles, phase means and the frame time histogram
+        void summarize( LFrameSummary& summary, int* histogram );
+
+        //Logs a note tagged with the current frame, frame thread only
+        void addNote( const char* note );
+
+        //Gets the newest note, empty if there are none
+        const char* getLatestNote();
+
+        //Draws the stacked phase graph and histogram, text goes through the glyph atlas
+        void render( float x, float y, Uint64 budgetNs, LTextAtlas& text );
+
+    private:
+        //Ring of finished frames, only the frame thread writes
+        LFrameRecord mRecords[ kCapacity ];
+
+        //Number of frames ever published
+        SDL_AtomicInt mWritten;
+
+        //Frame in progress
+        LFrameRecord mCurrent;
+        Uint64 mFrameStart;
+        Uint64 mLastMark;
+
+        //Recent notes, each starting with its frame number
+        char mNotes[ kNoteCount ][ kNoteLength ];
+        int mNoteCount;
+};
+
+class LPresentController
+{
+    public:
+        //Ways frames are held to the display rate
+        enum class ePresentMode
+        {
+            VSync,
+            AdaptiveVSync,
+            SoftwareCap
+        };
+
+        //Frames measured before each decision
+        static constexpr int kWindowFrames = 120;
+
+        //Clean windows needed before moving back to plain VSync
+        static constexpr int kSettleWindows = 3;
+
+        //Share of missed deadlines that counts as struggling and as clean
+        static constexpr double kMissedThreshold = 0.10;
+        static constexpr double kCleanThreshold = 0.01;
+
+        //Mean spin per frame the software cap may burn before VSync is tried again
+        static constexpr Uint64 kMaxSpinNS = 1000000;
+
+        //Initializes variables
+        LPresentController();
+
+        //Applies the starting mode and sets the frame budget, falls back to the software cap and returns false if the driver refuses the mode
+        bool start( Uint64 budgetNs, ePresentMode mode, LFramePacer& pacer );
+
+        //Switches automatic decisions on or off
+        void setAutomatic( bool automatic );
+        bool isAutomatic();
+
+        //Gets the mode in use
+        ePresentMode getMode();
+        const char* getModeName();
+
+        //Takes one frame's measurements and decides at the end of each window
+        void recordFrame( Uint64 frameNs, Uint64 presentNs, Uint64 spinNs, LFrameStats& stats );
+
+    private:
+        //Applies a mode to the renderer and pacer, returns false if the driver refuses it
+        bool applyMode( ePresentMode mode );
+
+        //Changes mode and logs why
+        void switchMode( ePresentMode mode, const char* reason, LFrameStats& stats );
+
+        //Clears the current window's measurements
+        void resetWindow();
+
+        //Pacer that enforces the software cap
+        LFramePacer* mPacer;
+
+        //Current mode and whether it changes by itself
+        ePresentMode mMode;
+        bool mAutomatic;
+
+        //Cleared when the driver rejects adaptive VSync
+        bool mAdaptiveSupported;
+
+        //Cleared when present was found not to block under VSync, so the cap stops retrying it
+        bool mVSyncHonored;
+
+        //Time allowed per frame
+        Uint64 mBudgetNs;
+
+        //Measurements for the current window
+        int mFrames;
+        int mMissedFrames;
+        int mFastFrames;
+        Uint64 mPresentNs;
+        Uint64 mSpinNs;
+
+        //Consecutive windows with almost no missed deadlines
+        int mCleanWindows;
+};
+
 
 
 /* Global Variables */
@@ -158,14 +485,77 @@ SDL_Renderer* gRenderer{ nullptr };
 //Global font
 TTF_Font* gFont{ nullptr };
 
-//The directional images
-LTexture gFpsTexture;
+//Glyphs for on screen text
+LTextAtlas gTextAtlas;
+
+//Per frame phase timings
+LFrameStats gFrameStats;
+
+//Wall clock, used directly by anything measuring real cost
+LRealClock gRealClock;
+
+//Clock timers and pacers read, scaled with --time-scale
+LClock* gClock{ &gRealClock };
 
 
 
 /* Class Implementations */
+//LClock Implementation
+bool LClock::isVirtual()
+{
+    return false;
+}
+
+
+//LRealClock Implementation
+Uint64 LRealClock::getTicksNS()
+{
+    return SDL_GetTicksNS();
+}
+
+void LRealClock::delayNS( Uint64 ns )
+{
+    SDL_DelayNS( ns );
+}
+
+
+//LScaledClock Implementation
+LScaledClock::LScaledClock( LClock& source, double scale ):
+    mSource( source ),
+    mScale{ scale },
+    mSourceAnchor{ source.getTicksNS() },
+    mTicksAnchor{ 0 }
+{
+
+}
+
+void LScaledClock::setScale( double scale )
+{
+    //Keep the time so far and scale from here on
+    mTicksAnchor = getTicksNS();
+    mSourceAnchor = mSource.getTicksNS();
+    mScale = scale;
+}
+
+double LScaledClock::getScale()
+{
+    return mScale;
+}
+
+Uint64 LScaledClock::getTicksNS()
+{
+    return mTicksAnchor + static_cast<Uint64>( ( mSource.getTicksNS() - mSourceAnchor ) * mScale );
+}
+
+void LScaledClock::delayNS( Uint64 ns )
+{
+    mSource.delayNS( static_cast<Uint64>( ns / mScale ) );
+}
+
+
 //LTimer Implementation
-LTimer::LTimer():
+LTimer::LTimer( LClock* clock ):
+    mClock{ clock },
     mStartTicks{ 0 },
     mPausedTicks{ 0 },
 
@@ -184,7 +574,7 @@ void LTimer::start()
     mPaused = false;
 
     //Get the current clock time
-    mStartTicks = SDL_GetTicksNS();
+    mStartTicks = getClock()->getTicksNS();
     mPausedTicks = 0;
 }
 
@@ -210,7 +600,7 @@ void LTimer::pause()
         mPaused = true;
 
         //Calculate the paused ticks
-        mPausedTicks = SDL_GetTicksNS() - mStartTicks;
+        mPausedTicks = getClock()->getTicksNS() - mStartTicks;
         mStartTicks = 0;
     }
 }
@@ -224,7 +614,7 @@ void LTimer::unpause()
         mPaused = false;
 
         //Reset the starting ticks
-        mStartTicks = SDL_GetTicksNS() - mPausedTicks;
+        mStartTicks = getClock()->getTicksNS() - mPausedTicks;
 
         //Reset the paused ticks
         mPausedTicks = 0;
@@ -248,7 +638,7 @@ Uint64 LTimer::getTicksNS()
         else
         {
             //Return the current time minus the start time
-            time = SDL_GetTicksNS() - mStartTicks;
+            time = getClock()->getTicksNS() - mStartTicks;
         }
     }
 
@@ -265,6 +655,157 @@ bool LTimer::isStarted()
     return mStarted;
 }
 
+LClock* LTimer::getClock()
+{
+    return mClock != nullptr ? mClock : gClock;
+}
+
+//LFramePacer Implementation
+LFramePacer::LFramePacer():
+    mPeriodNs{ 0 },
+    mDeadlineNs{ 0 },
+    mSpinMarginNs{ 2000000 },
+    mPacing{ ePacing::Hybrid },
+    mLastSpinNs{ 0 },
+    mErrors{},
+    mErrorCount{ 0 },
+    mNextError{ 0 }
+{
+
+}
+
+void LFramePacer::start( Uint64 periodNs, ePacing pacing )
+{
+    //Deadlines are absolute so late frames don't push later ones back
+    mPeriodNs = periodNs;
+    mDeadlineNs = periodNs;
+    mPacing = pacing;
+    clearStatistics();
+    mClock.start();
+}
+
+void LFramePacer::wait()
+{
+    Uint64 now{ mClock.getTicksNS() };
+    mLastSpinNs = 0;
+    if( now < mDeadlineNs )
+    {
+        //Sleep through most of the wait, hybrid pacing stops early enough to absorb oversleep
+        Uint64 margin{ mPacing == ePacing::Hybrid ? mSpinMarginNs : 0 };
+        if( mDeadlineNs - now > margin )
+        {
+            Uint64 requestedNs{ mDeadlineNs - now - margin };
+            mClock.getClock()->delayNS( requestedNs );
+            Uint64 woke{ mClock.getTicksNS() };
+
+            //Track oversleep, jump up to a new worst case and slowly come back down
+            Uint64 oversleepNs{ woke - now > requestedNs ? woke - now - requestedNs : 0 };
+            if( oversleepNs > mSpinMarginNs )
+            {
+                mSpinMarginNs = oversleepNs + oversleepNs / 4;
+            }
+            else
+            {
+                mSpinMarginNs -= ( mSpinMarginNs - oversleepNs ) / 64;
+            }
+            mSpinMarginNs = SDL_clamp( mSpinMarginNs, kMinSpinMarginNS, kMaxSpinMarginNS );
+            now = woke;
+        }
+
+        //Spin out the rest
+        Uint64 spinStart{ now };
+        while( now < mDeadlineNs )
+        {
+            SDL_CPUPauseInstruction();
+            now = mClock.getTicksNS();
+        }
+        mLastSpinNs = now - spinStart;
+    }
+
+    addSample( now - mDeadlineNs );
+
+    //Next deadline, resync instead of rushing frames to catch up if more than a frame behind
+    mDeadlineNs += mPeriodNs;
+    if( now >= mDeadlineNs )
+    {
+        mDeadlineNs = now + mPeriodNs;
+    }
+}
+
+void LFramePacer::setPacing( ePacing pacing )
+{
+    mPacing = pacing;
+    clearStatistics();
+}
+
+LFramePacer::ePacing LFramePacer::getPacing()
+{
+    return mPacing;
+}
+
+Uint64 LFramePacer::getMeanErrorNS()
+{
+    if( mErrorCount == 0 )
+    {
+        return 0;
+    }
+
+    Uint64 sum{ 0 };
+    for( int i = 0; i < mErrorCount; ++i )
+    {
+        sum += mErrors[ i ];
+    }
+    return sum / mErrorCount;
+}
+
+Uint64 LFramePacer::getP99ErrorNS()
+{
+    if( mErrorCount == 0 )
+    {
+        return 0;
+    }
+
+    //Select on a copy so the ring keeps its order
+    Uint64 sorted[ kJitterSamples ];
+    std::copy( mErrors, mErrors + mErrorCount, sorted );
+    int index{ ( mErrorCount - 1 ) * 99 / 100 };
+    std::nth_element( sorted, sorted + index, sorted + mErrorCount );
+    return sorted[ index ];
+}
+
+int LFramePacer::getSampleCount()
+{
+    return mErrorCount;
+}
+
+void LFramePacer::report()
+{
+    SDL_Log( "Frame pacer (%s): %d frames, wakeup error mean %.3f ms p99 %.3f ms, spin margin %.3f ms\n",
+        mPacing == ePacing::Hybrid ? "hybrid" : "sleep", mErrorCount,
+        getMeanErrorNS() / 1000000.0, getP99ErrorNS() / 1000000.0, mSpinMarginNs / 1000000.0 );
+}
+
+void LFramePacer::clearStatistics()
+{
+    mErrorCount = 0;
+    mNextError = 0;
+}
+
+Uint64 LFramePacer::getLastSpinNS()
+{
+    return mLastSpinNs;
+}
+
+void LFramePacer::addSample( Uint64 errorNs )
+{
+    mErrors[ mNextError ] = errorNs;
+    mNextError = ( mNextError + 1 ) % kJitterSamples;
+    if( mErrorCount < kJitterSamples )
+    {
+        ++mErrorCount;
+    }
+}
+
 //LButton Implementation
 LButton::LButton():
     mPosition{ 0.f, 0.f },
@@ -512,6 +1053,448 @@ bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColo
 #endif
 
 
+//LTextAtlas Implementation
+LTextAtlas::LTextAtlas():
+    mGlyphClips{}
+{
+
+}
+
+bool LTextAtlas::init( SDL_Color textColor )
+{
+    //Every printable character in order
+    char glyphs[ kGlyphCount + 1 ];
+    for( int i = 0; i < kGlyphCount; ++i )
+    {
+        glyphs[ i ] = static_cast<char>( kFirstGlyph + i );
+    }
+    glyphs[ kGlyphCount ] = '\0';
+
+    //Rasterize them all once
+    if( mGlyphs.loadFromRenderedText( glyphs, textColor ) == false )
+    {
+        return false;
+    }
+
+    //Each glyph spans from the end of the text before it to the end of the text including it
+    int left{ 0 };
+    for( int i = 0; i < kGlyphCount; ++i )
+    {
+        int right{ 0 }, height{ 0 };
+        TTF_GetStringSize( gFont, glyphs, i + 1, &right, &height );
+        mGlyphClips[ i ] = SDL_FRect{ static_cast<float>( left ), 0.f, static_cast<float>( right - left ), static_cast<float>( mGlyphs.getHeight() ) };
+        left = right;
+    }
+
+    return true;
+}
+
+void LTextAtlas::destroy()
+{
+    mGlyphs.destroy();
+}
+
+float LTextAtlas::getTextWidth( const char* text, float scale )
+{
+    float width{ 0.f };
+    for( const char* c = text; *c != '\0'; ++c )
+    {
+        if( *c >= kFirstGlyph && *c <= kLastGlyph )
+        {
+            width += mGlyphClips[ *c - kFirstGlyph ].w * scale;
+        }
+    }
+    return width;
+}
+
+float LTextAtlas::getLineHeight( float scale )
+{
+    return mGlyphs.getHeight() * scale;
+}
+
+void LTextAtlas::render( float x, float y, const char* text, float scale )
+{
+    for( const char* c = text; *c != '\0'; ++c )
+    {
+        //Skip anything outside the atlas
+        if( *c < kFirstGlyph || *c > kLastGlyph )
+        {
+            continue;
+        }
+
+        SDL_FRect* clip{ &mGlyphClips[ *c - kFirstGlyph ] };
+        mGlyphs.render( x, y, clip, clip->w * scale, clip->h * scale );
+        x += clip->w * scale;
+    }
+}
+
+
+//LFrameStats Implementation
+LFrameStats::LFrameStats():
+    mRecords{},
+    mWritten{},
+    mCurrent{},
+    mFrameStart{ 0 },
+    mLastMark{ 0 },
+    mNotes{},
+    mNoteCount{ 0 }
+{
+
+}
+
+void LFrameStats::beginFrame()
+{
+    mCurrent = LFrameRecord{};
+    mFrameStart = SDL_GetTicksNS();
+    mLastMark = mFrameStart;
+}
+
+void LFrameStats::mark( eFramePhase phase )
+{
+    Uint64 now{ SDL_GetTicksNS() };
+    mCurrent.phaseNs[ static_cast<int>( phase ) ] += now - mLastMark;
+    mLastMark = now;
+}
+
+void LFrameStats::endFrame()
+{
+    mCurrent.totalNs = mLastMark - mFrameStart;
+
+    //Fill the slot before publishing it, the atomic store is a full barrier
+    int written{ SDL_GetAtomicInt( &mWritten ) };
+    mRecords[ written & ( kCapacity - 1 ) ] = mCurrent;
+    SDL_SetAtomicInt( &mWritten, written + 1 );
+}
+
+int LFrameStats::snapshot( LFrameRecord* records )
+{
+    //Copy everything published so far
+    int written{ SDL_GetAtomicInt( &mWritten ) };
+    int count{ SDL_min( written, kCapacity ) };
+    int first{ written - count };
+    for( int i = 0; i < count; ++i )
+    {
+        records[ i ] = mRecords[ ( first + i ) & ( kCapacity - 1 ) ];
+    }
+
+    //Drop frames whose slots the writer reused or may be filling while they were copied
+    int overwritten{ SDL_GetAtomicInt( &mWritten ) + 1 - kCapacity - first };
+    if( overwritten >= count )
+    {
+        count = 0;
+    }
+    else if( overwritten > 0 )
+    {
+        count -= overwritten;
+        std::copy( records + overwritten, records + overwritten + count, records );
+    }
+
+    return count;
+}
+
+void LFrameStats::summarize( LFrameSummary& summary, int* histogram )
+{
+    summary = LFrameSummary{};
+    std::fill( histogram, histogram + kHistogramBuckets, 0 );
+
+    LFrameRecord records[ kCapacity ];
+    summary.frameCount = snapshot( records );
+    if( summary.frameCount == 0 )
+    {
+        return;
+    }
+
+    //Totals, phase sums and buckets in one pass
+    Uint64 totals[ kCapacity ];
+    for( int i = 0; i < summary.frameCount; ++i )
+    {
+        totals[ i ] = records[ i ].totalNs;
+        summary.maxNs = SDL_max( summary.maxNs, totals[ i ] );
+        for( int phase = 0; phase < static_cast<int>( eFramePhase::Count ); ++phase )
+        {
+            summary.phaseMeanNs[ phase ] += records[ i ].phaseNs[ phase ];
+        }
+        ++histogram[ SDL_min( totals[ i ] / kHistogramBucketNs, static_cast<Uint64>( kHistogramBuckets - 1 ) ) ];
+    }
+    for( int phase = 0; phase < static_cast<int>( eFramePhase::Count ); ++phase )
+    {
+        summary.phaseMeanNs[ phase ] /= summary.frameCount;
+    }
+
+    //Percentiles from successive partial sorts, each one narrows the range the next searches
+    int last{ summary.frameCount - 1 };
+    int p50{ last * 50 / 100 }, p95{ last * 95 / 100 }, p99{ last * 99 / 100 };
+    std::nth_element( totals, totals + p99, totals + summary.frameCount );
+    std::nth_element( totals, totals + p95, totals + p99 );
+    std::nth_element( totals, totals + p50, totals + p95 );
+    summary.p50Ns = totals[ p50 ];
+    summary.p95Ns = totals[ p95 ];
+    summary.p99Ns = totals[ p99 ];
+}
+
+void LFrameStats::addNote( const char* note )
+{
+    char* slot{ mNotes[ mNoteCount % kNoteCount ] };
+    SDL_snprintf( slot, kNoteLength, "frame %d: %s", SDL_GetAtomicInt( &mWritten ), note );
+    ++mNoteCount;
+    SDL_Log( "%s\n", slot );
+}
+
+const char* LFrameStats::getLatestNote()
+{
+    return mNoteCount == 0 ? "" : mNotes[ ( mNoteCount - 1 ) % kNoteCount ];
+}
+
+void LFrameStats::render( float x, float y, Uint64 budgetNs, LTextAtlas& text )
+{
+    //Phase colors in eFramePhase order
+    constexpr SDL_Color kPhaseColors[ static_cast<int>( eFramePhase::Count ) ]{
+        { 0x30, 0x80, 0xFF, 0xFF },
+        { 0x20, 0xC0, 0x40, 0xFF },
+        { 0xFF, 0x90, 0x00, 0xFF },
+        { 0xE0, 0x20, 0x20, 0xFF },
+        { 0xA0, 0xA0, 0xA0, 0xFF }
+    };
+    constexpr float kTextScale{ 0.5f };
+    constexpr float kHistogramBarWidth{ 4.f };
+
+    LFrameRecord records[ kCapacity ];
+    int count{ snapshot( records ) };
+    const float pixelsPerNs{ kGraphHeight / ( 2.f * budgetNs ) };
+
+    //Backdrop for the graph and histogram
+    SDL_FRect backdrop{ x, y, kCapacity + 8.f + kHistogramBuckets * kHistogramBarWidth, kGraphHeight };
+    SDL_SetRenderDrawColor( gRenderer, 0x20, 0x20, 0x20, 0xFF );
+    SDL_RenderFillRect( gRenderer, &backdrop );
+
+    //One column per frame with phases stacked bottom up, one batched call per phase
+    SDL_FRect bars[ kCapacity ];
+    float stackHeights[ kCapacity ]{};
+    for( int phase = 0; phase < static_cast<int>( eFramePhase::Count ); ++phase )
+    {
+        for( int i = 0; i < count; ++i )
+        {
+            float height{ SDL_min( records[ i ].phaseNs[ phase ] * pixelsPerNs, kGraphHeight - stackHeights[ i ] ) };
+            bars[ i ] = SDL_FRect{ x + kCapacity - count + i, y + kGraphHeight - stackHeights[ i ] - height, 1.f, height };
+            stackHeights[ i ] += height;
+        }
+        SDL_SetRenderDrawColor( gRenderer, kPhaseColors[ phase ].r, kPhaseColors[ phase ].g, kPhaseColors[ phase ].b, kPhaseColors[ phase ].a );
+        SDL_RenderFillRects( gRenderer, bars, count );
+    }
+
+    //Frame budget line
+    SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF );
+    SDL_RenderLine( gRenderer, x, y + kGraphHeight / 2.f, x + kCapacity, y + kGraphHeight / 2.f );
+
+    //Histogram bars scaled to the fullest bucket
+    LFrameSummary summary;
+    int histogram[ kHistogramBuckets ];
+    summarize( summary, histogram );
+    int fullest{ *std::max_element( histogram, histogram + kHistogramBuckets ) };
+    float histogramX{ x + kCapacity + 8.f };
+    for( int i = 0; i < kHistogramBuckets && fullest > 0; ++i )
+    {
+        float height{ kGraphHeight * histogram[ i ] / fullest };
+        bars[ i ] = SDL_FRect{ histogramX + i * kHistogramBarWidth, y + kGraphHeight - height, kHistogramBarWidth - 1.f, height };
+    }
+    SDL_SetRenderDrawColor( gRenderer, 0xC0, 0xC0, 0x40, 0xFF );
+    SDL_RenderFillRects( gRenderer, bars, fullest > 0 ? kHistogramBuckets : 0 );
+
+    //Percentiles and phase means under the graph
+    char line[ 128 ];
+    float lineY{ y + kGraphHeight + 2.f };
+    SDL_snprintf( line, sizeof( line ), "p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms",
+        summary.p50Ns / 1000000.0, summary.p95Ns / 1000000.0, summary.p99Ns / 1000000.0, summary.maxNs / 1000000.0 );
+    text.render( x, lineY, line, kTextScale );
+
+    lineY += text.getLineHeight( kTextScale );
+    SDL_snprintf( line, sizeof( line ), "events %.2f  update %.2f  render %.2f  present %.2f  sleep %.2f",
+        summary.phaseMeanNs[ 0 ] / 1000000.0, summary.phaseMeanNs[ 1 ] / 1000000.0, summary.phaseMeanNs[ 2 ] / 1000000.0,
+        summary.phaseMeanNs[ 3 ] / 1000000.0, summary.phaseMeanNs[ 4 ] / 1000000.0 );
+    text.render( x, lineY, line, kTextScale );
+
+    //Last decision made from these numbers
+    lineY += text.getLineHeight( kTextScale );
+    text.render( x, lineY, getLatestNote(), kTextScale );
+}
+
+//LPresentController Implementation
+LPresentController::LPresentController():
+    mPacer{ nullptr },
+    mMode{ ePresentMode::VSync },
+    mAutomatic{ false },
+    mAdaptiveSupported{ true },
+    mVSyncHonored{ true },
+    mBudgetNs{ 0 },
+    mFrames{ 0 },
+    mMissedFrames{ 0 },
+    mFastFrames{ 0 },
+    mPresentNs{ 0 },
+    mSpinNs{ 0 },
+    mCleanWindows{ 0 }
+{
+
+}
+
+bool LPresentController::start( Uint64 budgetNs, ePresentMode mode, LFramePacer& pacer )
+{
+    mPacer = &pacer;
+    mBudgetNs = budgetNs;
+    mCleanWindows = 0;
+    resetWindow();
+
+    //Don't start on VSync the driver was found to ignore
+    if( mode == ePresentMode::VSync && mVSyncHonored == false )
+    {
+        mode = ePresentMode::SoftwareCap;
+    }
+
+    //The pacer can hold the rate when the driver refuses a VSync mode
+    if( applyMode( mode ) )
+    {
+        return true;
+    }
+    SDL_Log( "Unable to set present mode! SDL error: %s\n", SDL_GetError() );
+    if( mode != ePresentMode::SoftwareCap && applyMode( ePresentMode::SoftwareCap ) == false )
+    {
+        SDL_Log( "Unable to fall back to the software cap! SDL error: %s\n", SDL_GetError() );
+    }
+    return false;
+}
+
+void LPresentController::setAutomatic( bool automatic )
+{
+    mAutomatic = automatic;
+    mCleanWindows = 0;
+    resetWindow();
+}
+
+void LPresentController::resetWindow()
+{
+    mFrames = 0;
+    mMissedFrames = 0;
+    mFastFrames = 0;
+    mPresentNs = 0;
+    mSpinNs = 0;
+}
+
+bool LPresentController::isAutomatic()
+{
+    return mAutomatic;
+}
+
+LPresentController::ePresentMode LPresentController::getMode()
+{
+    return mMode;
+}
+
+const char* LPresentController::getModeName()
+{
+    switch( mMode )
+    {
+        case ePresentMode::VSync: return "VSync";
+        case ePresentMode::AdaptiveVSync: return "Adaptive VSync";
+        case ePresentMode::SoftwareCap: return "Cap";
+    }
+    return "";
+}
+
+void LPresentController::recordFrame( Uint64 frameNs, Uint64 presentNs, Uint64 spinNs, LFrameStats& stats )
+{
+    //Late frames miss a refresh, frames well under budget mean nothing is holding the rate
+    ++mFrames;
+    mMissedFrames += frameNs > mBudgetNs + mBudgetNs / 20 ? 1 : 0;
+    mFastFrames += frameNs < mBudgetNs - mBudgetNs / 5 ? 1 : 0;
+    mPresentNs += presentNs;
+    mSpinNs += spinNs;
+    if( mFrames < kWindowFrames )
+    {
+        return;
+    }
+
+    double missedShare{ static_cast<double>( mMissedFrames ) / mFrames };
+    double fastShare{ static_cast<double>( mFastFrames ) / mFrames };
+    Uint64 meanPresentNs{ mPresentNs / mFrames };
+    Uint64 meanSpinNs{ mSpinNs / mFrames };
+    mCleanWindows = missedShare < kCleanThreshold ? mCleanWindows + 1 : 0;
+    resetWindow();
+    if( mAutomatic == false )
+    {
+        return;
+    }
+
+    char reason[ 128 ];
+    if( mMode == ePresentMode::VSync && missedShare > kMissedThreshold )
+    {
+        //Strict VSync holds late frames a whole refresh, tear them instead
+        SDL_snprintf( reason, sizeof( reason ), "%.0f%% of frames missed the deadline under VSync", missedShare * 100.0 );
+        switchMode( mAdaptiveSupported ? ePresentMode::AdaptiveVSync : ePresentMode::SoftwareCap, reason, stats );
+    }
+    else if( mMode == ePresentMode::VSync && fastShare > 0.5 && meanPresentNs < 100000 )
+    {
+        //Present isn't blocking and frames run fast, so the driver is ignoring VSync
+        SDL_snprintf( reason, sizeof( reason ), "present blocked %.3f ms on average with %.0f%% fast frames, VSync not honored", meanPresentNs / 1000000.0, fastShare * 100.0 );
+        mVSyncHonored = false;
+        switchMode( ePresentMode::SoftwareCap, reason, stats );
+    }
+    else if( mMode == ePresentMode::AdaptiveVSync && mCleanWindows >= kSettleWindows )
+    {
+        //Frames fit again, go back to never tearing
+        SDL_snprintf( reason, sizeof( reason ), "no missed deadlines for %d windows", mCleanWindows );
+        switchMode( ePresentMode::VSync, reason, stats );
+    }
+    else if( mMode == ePresentMode::SoftwareCap && mVSyncHonored && mCleanWindows >= kSettleWindows && meanSpinNs > kMaxSpinNS )
+    {
+        //The cap is holding but burning CPU, let the display pace frames unless it already ignored VSync
+        SDL_snprintf( reason, sizeof( reason ), "cap spun %.3f ms per frame with no missed deadlines", meanSpinNs / 1000000.0 );
+        switchMode( ePresentMode::VSync, reason, stats );
+    }
+}
+
+bool LPresentController::applyMode( ePresentMode mode )
+{
+    bool applied{ true };
+    switch( mode )
+    {
+        case ePresentMode::VSync:
+            applied = SDL_SetRenderVSync( gRenderer, 1 );
+            break;
+
+        case ePresentMode::AdaptiveVSync:
+            applied = SDL_SetRenderVSync( gRenderer, SDL_RENDERER_VSYNC_ADAPTIVE );
+            break;
+
+        case ePresentMode::SoftwareCap:
+            applied = SDL_SetRenderVSync( gRenderer, SDL_RENDERER_VSYNC_DISABLED );
+
+            //Deadlines restart from now
+            mPacer->start( mBudgetNs, mPacer->getPacing() );
+            break;
+    }
+
+    if( applied )
+    {
+        mMode = mode;
+    }
+    return applied;
+}
+
+void LPresentController::switchMode( ePresentMode mode, const char* reason, LFrameStats& stats )
+{
+    //Fall back to the software cap if the driver has no adaptive VSync
+    const char* previousName{ getModeName() };
+    if( applyMode( mode ) == false && mode == ePresentMode::AdaptiveVSync )
+    {
+        mAdaptiveSupported = false;
+        applyMode( ePresentMode::SoftwareCap );
+    }
+    mCleanWindows = 0;
+
+    char note[ LFrameStats::kNoteLength ];
+    SDL_snprintf( note, sizeof( note ), "%s -> %s: %s", previousName, getModeName(), reason );
+    stats.addNote( note );
+}
+
 /* Function Implementations */
 bool init()
 {
@@ -571,7 +1554,7 @@ bool loadMedia()
     {
         //Load text
         SDL_Color textColor{ 0x00, 0x00, 0x00, 0xFF };
-        if( gFpsTexture.loadFromRenderedText( "The quick brown fox jumps over the lazy dog", textColor ) == false )
+        if( gTextAtlas.init( textColor ) == false )
         {
             SDL_Log( "Could not load text texture %s! SDL_ttf Error: %s\n", fontPath.c_str(), SDL_GetError() );
             success = false;
@@ -597,8 +1580,8 @@ void close()
     TTF_CloseFont( gFont );
     gFont = nullptr;
 
-    //Clean up button
-    gFpsTexture.destroy();
+    //Clean up text atlas
+    gTextAtlas.destroy();
 
     //Destroy window
     SDL_DestroyRenderer( gRenderer );
@@ -617,6 +1600,25 @@ int main( int argc, char* args[] )
     //Final exit code
     int exitCode{ 0 };
 
+    //Run timers faster or slower than real time if asked
+    LScaledClock scaledClock{ gRealClock, 1.0 };
+    for( int i = 1; i < argc; ++i )
+    {
+        if( SDL_strcmp( args[ i ], "--time-scale" ) == 0 && i + 1 < argc )
+        {
+            double scale{ SDL_atof( args[ ++i ] ) };
+            if( scale > 0.0 )
+            {
+                scaledClock.setScale( scale );
+                gClock = &scaledClock;
+            }
+            else
+            {
+                SDL_Log( "Time scale %s is not positive, using the real clock\n", args[ i ] );
+            }
+        }
+    }
+
     //Initialize
     if( init() == false )
     {
@@ -647,13 +1649,23 @@ int main( int argc, char* args[] )
             bool fpsCapEnabled{ false };
 
             //Timer to cap frame rate
-            LTimer capTimer;
+            LTimer capTimer{ &gRealClock };
+
+            //Waits out capped frames and measures how close wakeups land
+            LFramePacer framePacer;
+
+            //Picks VSync, adaptive VSync or the cap from measured frames, toggled with A
+            LPresentController presentController;
+            if( presentController.start( 1000000000 / kScreenFps, LPresentController::ePresentMode::VSync, framePacer ) == false )
+            {
+                SDL_Log( "VSync unavailable, present controller starts on the software cap\n" );
+            }
 
             //Time spent rendering
             Uint64 renderingNS{ 0 };
 
-            //In memory text stream
-            std::stringstream timeText;
+            //Frame rate text
+            char timeText[ 64 ]{};
 
             //Rotation degrees
             double degrees = 0.0;
@@ -676,6 +1688,7 @@ int main( int argc, char* args[] )
             {
                 // Start frame time
                 capTimer.start();
+                gFrameStats.beginFrame();
 
                 //Get event data
                 while( SDL_PollEvent( &e ) == true )
@@ -694,12 +1707,43 @@ int main( int argc, char* args[] )
                         if( e.key.key == SDLK_RETURN )
                         {
                             vsyncEnabled = !vsyncEnabled;
+                            presentController.setAutomatic( false );
                             SDL_SetRenderVSync( gRenderer, ( vsyncEnabled ) ? 1 : SDL_RENDERER_VSYNC_DISABLED );
                         }
                         //FPS cap toggle
                         else if( e.key.key == SDLK_SPACE )
                         {
                             fpsCapEnabled = !fpsCapEnabled;
+                            presentController.setAutomatic( false );
+
+                            //Deadlines restart from now
+                            if( fpsCapEnabled )
+                            {
+                                framePacer.start( 1000000000 / kScreenFps, framePacer.getPacing() );
+                            }
+                        }
+                        //Automatic present mode toggle, going back to manual restores the manual settings
+                        else if( e.key.key == SDLK_A )
+                        {
+                            presentController.setAutomatic( !presentController.isAutomatic() );
+                            if( presentController.isAutomatic() )
+                            {
+                                if( presentController.start( 1000000000 / kScreenFps, LPresentController::ePresentMode::VSync, framePacer ) == false )
+                                {
+                                    SDL_Log( "VSync unavailable, present controller starts on the software cap\n" );
+                                }
+                            }
+                            else
+                            {
+                                SDL_SetRenderVSync( gRenderer, ( vsyncEnabled ) ? 1 : SDL_RENDERER_VSYNC_DISABLED );
+                                framePacer.start( 1000000000 / kScreenFps, framePacer.getPacing() );
+                            }
+                        }
+                        //Pacing toggle, reports the old mode so the two can be compared
+                        else if( e.key.key == SDLK_P )
+                        {
+                            framePacer.report();
+                            framePacer.setPacing( framePacer.getPacing() == LFramePacer::ePacing::Hybrid ? LFramePacer::ePacing::Sleep : LFramePacer::ePacing::Hybrid );
                         }
                     }
 
@@ -718,42 +1762,66 @@ int main( int argc, char* args[] )
                     //     buttons[ i ].handleEvent( &e );
                     // }
                 }
+                gFrameStats.mark( eFramePhase::Events );
+
+                //The controller decides capping while it is automatic
+                bool capping{ presentController.isAutomatic() ? presentController.getMode() == LPresentController::ePresentMode::SoftwareCap : fpsCapEnabled };
 
-                //Update text
+                //Update text, drawn from the glyph atlas so nothing is rasterized per frame
                 if( renderingNS != 0 )
                 {
                     double framesPerSecond{ 1000000000.0 / static_cast<double>( renderingNS ) };
-
-                    timeText.str( "" );
-                    timeText << "Frames per second " << ( vsyncEnabled ? "(VSync) " : "" ) << ( fpsCapEnabled ? "(Cap) " : "" ) << framesPerSecond; 
-                    SDL_Color textColor{ 0x00, 0x00, 0x00, 0xFF };
-                    gFpsTexture.loadFromRenderedText( timeText.str().c_str(), textColor );
+                    if( presentController.isAutomatic() )
+                    {
+                        SDL_snprintf( timeText, sizeof( timeText ), "Frames per second (Auto %s) %.1f", presentController.getModeName(), framesPerSecond );
+                    }
+                    else
+                    {
+                        SDL_snprintf( timeText, sizeof( timeText ), "Frames per second %s%s%.1f", vsyncEnabled ? "(VSync) " : "", fpsCapEnabled ? "(Cap) " : "", framesPerSecond );
+                    }
                 }
+                gFrameStats.mark( eFramePhase::Update );
 
                 //Fill the background
                 SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF,  0xFF );
                 SDL_RenderClear( gRenderer );
 
                 //Draw text
-                gFpsTexture.render( ( kScreenWidth - gFpsTexture.getWidth() ) / 2.f,  ( kScreenHeight - gFpsTexture.getHeight() ) / 2.f );
+                gTextAtlas.render( ( kScreenWidth - gTextAtlas.getTextWidth( timeText ) ) / 2.f,  ( kScreenHeight - gTextAtlas.getLineHeight() ) / 2.f, timeText );
+
+                //Draw frame statistics
+                gFrameStats.render( 8.f, 8.f, 1000000000 / kScreenFps, gTextAtlas );
+                gFrameStats.mark( eFramePhase::Render );
 
                 //Update screen
+                Uint64 presentStart{ SDL_GetTicksNS() };
                 SDL_RenderPresent(gRenderer);
+                Uint64 presentNs{ SDL_GetTicksNS() - presentStart };
+                gFrameStats.mark( eFramePhase::Present );
 
                 //Get time to render frame
                 renderingNS = capTimer.getTicksNS();
 
-                //If time remaining in frame
-                constexpr Uint64 nsPerFrame = 1000000000 / kScreenFps; 
-                if( fpsCapEnabled && renderingNS < nsPerFrame)
+                //Wait for the frame deadline
+                if( capping )
                 {
-                    //Sleep remaining frame time
-                    Uint64 sleepTime = nsPerFrame - renderingNS;
-                    SDL_DelayNS( nsPerFrame - renderingNS );
+                    framePacer.wait();
+
+                    //Log jitter every time the statistics window fills
+                    if( framePacer.getSampleCount() == LFramePacer::kJitterSamples )
+                    {
+                        framePacer.report();
+                        framePacer.clearStatistics();
+                    }
 
-                    //Get frame time including sleep time
+                    //Get frame time including wait time
                     renderingNS = capTimer.getTicksNS();
                 }
+                gFrameStats.mark( eFramePhase::Sleep );
+                gFrameStats.endFrame();
+
+                //Let the controller judge the finished frame
+                presentController.recordFrame( renderingNS, presentNs, capping ? framePacer.getLastSpinNS() : 0, gFrameStats );
 
                 //Fill the background
                 // SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
@@ -57,6 +57,38 @@ private:
     int mHeight;
 };
 
+class LKeyboardSnapshot
+{
+public:
+    //Scancodes packed 64 to a word
+    static constexpr int kWordCount = ( SDL_SCANCODE_COUNT + 63 ) / 64;
+
+    //Initializes with every key up
+    LKeyboardSnapshot();
+
+    //Copies the keyboard state and finds the keys that changed since the last update, call after polling events
+    void update();
+
+    //Checks if a key is down in this snapshot
+    bool isDown( SDL_Scancode scancode ) const;
+
+    //Checks if a key went down or up between the last two snapshots
+    bool wasPressed( SDL_Scancode scancode ) const;
+    bool wasReleased( SDL_Scancode scancode ) const;
+
+private:
+    //Gets a scancode's bit from a bitset
+    static bool getBit( const Uint64* bits, SDL_Scancode scancode );
+
+    //Key bits this update and last update
+    Uint64 mCurrent[ kWordCount ];
+    Uint64 mPrevious[ kWordCount ];
+
+    //Keys that went down and up between them
+    Uint64 mPressed[ kWordCount ];
+    Uint64 mReleased[ kWordCount ];
+};
+
 
 
 /* Global Variables */
@@ -153,6 +185,60 @@ void LTexture::render( float x, float y )
     SDL_RenderTexture( gRenderer, mTexture, nullptr, &dstRect );
 }
 
+//LKeyboardSnapshot Implementation
+LKeyboardSnapshot::LKeyboardSnapshot()
+{
+    SDL_zeroa( mCurrent );
+    SDL_zeroa( mPrevious );
+    SDL_zeroa( mPressed );
+    SDL_zeroa( mReleased );
+}
+
+void LKeyboardSnapshot::update()
+{
+    //Keep last snapshot
+    SDL_memcpy( mPrevious, mCurrent, sizeof( mCurrent ) );
+
+    //Pack SDL's bool per scancode into bits
+    int keyCount{ 0 };
+    const bool* keyStates{ SDL_GetKeyboardState( &keyCount ) };
+    keyCount = SDL_min( keyCount, static_cast<int>( SDL_SCANCODE_COUNT ) );
+    SDL_zeroa( mCurrent );
+    for( int i = 0; i < keyCount; ++i )
+    {
+        mCurrent[ i / 64 ] |= static_cast<Uint64>( keyStates[ i ] ) << ( i % 64 );
+    }
+
+    //Changed keys are pressed if down now and released if down before, a word at a time
+    for( int w = 0; w < kWordCount; ++w )
+    {
+        Uint64 changed{ mCurrent[ w ] ^ mPrevious[ w ] };
+        mPressed[ w ] = changed & mCurrent[ w ];
+        mReleased[ w ] = changed & mPrevious[ w ];
+    }
+}
+
+bool LKeyboardSnapshot::isDown( SDL_Scancode scancode ) const
+{
+    return getBit( mCurrent, scancode );
+}
+
+bool LKeyboardSnapshot::wasPressed( SDL_Scancode scancode ) const
+{
+    return getBit( mPressed, scancode );
+}
+
+bool LKeyboardSnapshot::wasReleased( SDL_Scancode scancode ) const
+{
+    return getBit( mReleased, scancode );
+}
+
+bool LKeyboardSnapshot::getBit( const Uint64* bits, SDL_Scancode scancode )
+{
+    int index{ static_cast<int>( scancode ) };
+    return index >= 0 && index < SDL_SCANCODE_COUNT && ( ( bits[ index / 64 ] >> ( index % 64 ) ) & 1 );
+}
+
 
 
 /* Function Implementations */
@@ -264,6 +350,23 @@ int main( int argc, char* args[] )
 
             //Background color defaults to white
             SDL_Color bgColor{ 0xFF, 0xFF, 0xFF, 0xFF };
+
+            //Keyboard state each frame
+            LKeyboardSnapshot keyboard;
+
+            //Texture shown when each arrow is pressed and background while it is held, earlier entries win
+            struct LArrowKey
+            {
+                SDL_Scancode scancode;
+                LTexture* texture;
+                SDL_Color color;
+            };
+            const LArrowKey arrowKeys[] = {
+                { SDL_SCANCODE_UP, &gUpTexture, { 0xFF, 0x00, 0x00, 0xFF } },
+                { SDL_SCANCODE_DOWN, &gDownTexture, { 0x00, 0xFF, 0x00, 0xFF } },
+                { SDL_SCANCODE_LEFT, &gLeftTexture, { 0xFF, 0xFF, 0x00, 0xFF } },
+                { SDL_SCANCODE_RIGHT, &gRightTexture, { 0x00, 0x00, 0xFF, 0xFF } }
+            };
             
             //The main loop
             while( quit == false )
@@ -277,63 +380,30 @@ int main( int argc, char* args[] )
                         //End the main loop
                         quit = true;
                     }
-                    //On keyboard key press
-                    else if( e.type == SDL_EVENT_KEY_DOWN )
-                    {
-                        //Set texture
-                        if( e.key.key == SDLK_UP )
-                        {
-                            currentTexture = &gUpTexture;
-                        }
-                        else if( e.key.key == SDLK_DOWN )
-                        {
-                            currentTexture = &gDownTexture;
-                        }
-                        else if( e.key.key == SDLK_LEFT )
-                        {
-                            currentTexture = &gLeftTexture;
-                        }
-                        else if( e.key.key == SDLK_RIGHT )
-                        {
-                            currentTexture = &gRightTexture;
-                        }
-                    }
                 }
 
-                 //Reset background color to white
-                bgColor.r = 0xFF;
-                bgColor.g = 0xFF;
-                bgColor.b = 0xFF;
+                //Take this frame's keyboard state
+                keyboard.update();
 
-                //Set background color based on key state
-                const bool* keyStates = SDL_GetKeyboardState( nullptr );
-                if( keyStates[ SDL_SCANCODE_UP ] == true )
-                {
-                    //Red
-                    bgColor.r = 0xFF;
-                    bgColor.g = 0x00;
-                    bgColor.b = 0x00;
-                }
-                else if( keyStates[ SDL_SCANCODE_DOWN ] == true )
-                {
-                    //Green
-                    bgColor.r = 0x00;
-                    bgColor.g = 0xFF;
-                    bgColor.b = 0x00;
-                }
-                else if( keyStates[ SDL_SCANCODE_LEFT ] == true )
+                //Set texture to the arrow pressed this frame
+                for( const LArrowKey& arrowKey : arrowKeys )
                 {
-                    //Yellow
-                    bgColor.r = 0xFF;
-                    bgColor.g = 0xFF;
-                    bgColor.b = 0x00;
+                    if( keyboard.wasPressed( arrowKey.scancode ) )
+                    {
+                        currentTexture = arrowKey.texture;
+                        break;
+                    }
                 }
-                else if( keyStates[ SDL_SCANCODE_RIGHT ] == true )
+
+                //Set background color based on key state, white if no arrow is held
+                bgColor = SDL_Color{ 0xFF, 0xFF, 0xFF, 0xFF };
+                for( const LArrowKey& arrowKey : arrowKeys )
                 {
-                    //Blue
-                    bgColor.r = 0x00;
-                    bgColor.g = 0x00;
-                    bgColor.b = 0xFF;
+                    if( keyboard.isDown( arrowKey.scancode ) )
+                    {
+                        bgColor = arrowKey.color;
+                        break;
+                    }
                 }
 
                 //Fill the background 
@@ -9,6 +9,10 @@
 #include <SDL3_ttf/SDL_ttf.h>
 #include <string>
 #include <sstream>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <deque>
 
 /* Constants */
 //Screen dimension constants
@@ -16,6 +20,12 @@ constexpr int kScreenWidth{ 640 };
 constexpr int kScreenHeight{ 480 };
 constexpr int kScreenFps{ 60 };
 
+//Simulation steps per second, independent of the render rate
+constexpr int kSimulationHz{ 120 };
+
+//Frames a headless run lasts unless --frames says otherwise
+constexpr int kDefaultHeadlessFrames{ 1000 };
+
 
 /* Function Prototypes */
 //Starts up SDL and creates window
@@ -27,6 +37,86 @@ bool loadMedia();
 //Frees media and shuts down SDL
 void close();
 
+//Game actions keys can be bound to
+enum class eAction
+{
+    MoveUp = 0,
+    MoveDown = 1,
+    MoveLeft = 2,
+    MoveRight = 3,
+    Count = 4
+};
+
+//Axes built from a negative and a positive action
+enum class eAxis
+{
+    MoveX = 0,
+    MoveY = 1,
+    Count = 2
+};
+
+class LInputActions
+{
+    public:
+        //Table sizes
+        static constexpr int kActionCount = static_cast<int>( eAction::Count );
+        static constexpr int kAxisCount = static_cast<int>( eAxis::Count );
+
+        //Scancode table entry with no action
+        static constexpr Uint8 kUnbound = 0xFF;
+
+        //Initializes with no bindings
+        LInputActions();
+
+        //Binds a key to an action, replacing what the key was bound to
+        void bind( SDL_Scancode scancode, eAction action );
+
+        //Removes a key's binding
+        void unbind( SDL_Scancode scancode );
+
+        //Builds an axis from two actions
+        void bindAxis( eAxis axis, eAction negative, eAction positive );
+
+        //Clears last frame's pressed and released states, call before the event batch
+        void beginFrame();
+
+        //Updates action states from a key event
+        void handleEvent( const SDL_Event& e );
+
+        //Action states for this frame
+        bool isPressed( eAction action ) const;
+        bool isHeld( eAction action ) const;
+        bool isReleased( eAction action ) const;
+
+        //Gets -1, 0 or 1 from the axis actions being held
+        float getAxis( eAxis axis ) const;
+
+        //Gets the timestamp of the last event that changed an action
+        Uint64 getChangeTimestamp() const;
+
+    private:
+        //Moves a held key's contribution from one action to another
+        void rebindHeld( SDL_Scancode scancode, Uint8 action );
+
+        //Action per scancode and which scancodes are down
+        Uint8 mScancodeActions[ SDL_SCANCODE_COUNT ];
+        bool mScancodeDown[ SDL_SCANCODE_COUNT ];
+
+        //Keys holding each action
+        Uint8 mHeldKeys[ kActionCount ];
+
+        //Action bits that went down or up this frame
+        Uint32 mPressed;
+        Uint32 mReleased;
+
+        //Actions making up each axis
+        Uint8 mAxisNegative[ kAxisCount ];
+        Uint8 mAxisPositive[ kAxisCount ];
+
+        //Last time an action changed
+        Uint64 mChangeTimestamp;
+};
+
 class Dot
 {
     public:
@@ -34,34 +124,113 @@ class Dot
         static constexpr int kDotWidth = 20;
         static constexpr int kDotHeight = 20;
 
-        //Maximum axis velocity of the dot
-        static constexpr int kDotVel = 10;
+        //Maximum axis velocity of the dot in pixels per second
+        static constexpr float kDotVel = 600.f;
 
         //Initializes the variables
         Dot();
 
-        //Takes key presses and adjusts the dot's velocity
-        void handleEvent( SDL_Event& e );
+        //Sets the dot's velocity from this frame's movement axes
+        void handleActions( const LInputActions& actions );
 
-        //Moves the dot
-        void move();
+        //Moves the dot by one simulation step
+        void move( float stepSeconds );
 
-        //Shows the dot on the screen
-        void render();
+        //Shows the dot on the screen between its previous and current position
+        void render( float alpha );
+
+        //Checks if the dot is heading somewhere
+        bool isMoving();
+
+        //Gets the dot's position after the last step
+        float getPosX();
+        float getPosY();
 
     private:
         //The X and Y offsets of the dot
-        int mPosX, mPosY;
+        float mPosX, mPosY;
+
+        //The offsets before the last step
+        float mPrevPosX, mPrevPosY;
 
         //The velocity of the dot
-        int mVelX, mVelY;
+        float mVelX, mVelY;
 };
 
-class LTimer
+class LClock
+{
+    public:
+        //Cleans up the clock
+        virtual ~LClock() = default;
+
+        //Gets the clock's time
+        virtual Uint64 getTicksNS() = 0;
+
+        //Waits for an amount of the clock's time
+        virtual void delayNS( Uint64 ns ) = 0;
+
+        //Checks if time only moves when asked to, busy waiting on these never ends
+        virtual bool isVirtual();
+};
+
+class LRealClock : public LClock
+{
+    public:
+        //Wall clock time since SDL started
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+};
+
+class LScaledClock : public LClock
+{
+    public:
+        //Initializes variables
+        LScaledClock( LClock& source, double scale );
+
+        //Changes speed without making time jump
+        void setScale( double scale );
+        double getScale();
+
+        //Source time multiplied by the scale
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+
+    private:
+        //Clock being scaled
+        LClock& mSource;
+
+        //Time multiplier
+        double mScale;
+
+        //Source and scaled time when the scale last changed
+        Uint64 mSourceAnchor;
+        Uint64 mTicksAnchor;
+};
+
+class LSteppedClock : public LClock
 {
     public:
         //Initializes variables
-        LTimer();
+        LSteppedClock();
+
+        //Moves time forward
+        void step( Uint64 ns );
+
+        //Time only moves when stepped or delayed, delays return immediately
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+        bool isVirtual() override;
+
+    private:
+        //Current time
+        Uint64 mTicks;
+};
+
+class LTimer
+{
+    public:
+        //Initializes variables, timers read the global clock unless given their own
+        LTimer( LClock* clock = nullptr );
 
         //The various clock actions
         void start();
@@ -76,7 +245,13 @@ class LTimer
         bool isStarted();
         bool isPaused();
 
+        //Gets the clock the timer reads
+        LClock* getClock();
+
     private:
+        //Clock this timer always reads, null to follow the global clock
+        LClock* mClock;
+
         //The clock time when the timer started
         Uint64 mStartTicks;
 
@@ -88,6 +263,406 @@ class LTimer
         bool mStarted;
 };
 
+class LFramePacer
+{
+    public:
+        //How waits reach the deadline
+        enum class ePacing
+        {
+            Sleep,
+            Hybrid
+        };
+
+        //Number of recent frames the jitter statistics cover
+        static constexpr int kJitterSamples = 600;
+
+        //Limits for the calibrated time left to spin after sleeping
+        static constexpr Uint64 kMinSpinMarginNS = 200000;
+        static constexpr Uint64 kMaxSpinMarginNS = 4000000;
+
+        //Initializes variables
+        LFramePacer();
+
+        //Starts pacing with the first deadline one period from now
+        void start( Uint64 periodNs, ePacing pacing = ePacing::Hybrid );
+
+        //Waits for the current deadline and sets the next one
+        void wait();
+
+        //Switches how waits reach the deadline and clears statistics
+        void setPacing( ePacing pacing );
+        ePacing getPacing();
+
+        //Gets how far wakeups landed from their deadlines
+        Uint64 getMeanErrorNS();
+        Uint64 getP99ErrorNS();
+        int getSampleCount();
+
+        //Logs jitter statistics
+        void report();
+
+        //Starts a new statistics window
+        void clearStatistics();
+
+        //Changes the period starting with the next deadline
+        void setPeriod( Uint64 periodNs );
+
+        //Lets pending events end waits early
+        void setWakeOnEvent( bool wakeOnEvent );
+
+    private:
+        //Stores the wakeup error for a frame
+        void addSample( Uint64 errorNs );
+
+        //Clock deadlines are measured on
+        LTimer mClock;
+
+        //Frame period and the absolute time of the next deadline
+        Uint64 mPeriodNs;
+        Uint64 mDeadlineNs;
+
+        //Time before the deadline when sleeping stops, grows with observed oversleep
+        Uint64 mSpinMarginNs;
+
+        //How waits reach the deadline
+        ePacing mPacing;
+
+        //Whether events end waits early
+        bool mWakeOnEvent;
+
+        //Recent wakeup errors
+        Uint64 mErrors[ kJitterSamples ];
+        int mErrorCount;
+        int mNextError;
+};
+
+class LFixedTimestep
+{
+    public:
+        //Most simulation steps one frame can run before time is dropped
+        static constexpr int kMaxCatchUpSteps = 8;
+
+        //Initializes variables
+        LFixedTimestep();
+
+        //Starts stepping at the given rate
+        void start( int stepsPerSecond );
+
+        //Adds the time since the last frame to the accumulator
+        void beginFrame();
+
+        //Takes one step's worth of time from the accumulator if there is enough
+        bool step();
+
+        //Gets the simulated time per step
+        float getStepSeconds();
+
+        //Gets how far rendering is between the previous and current step
+        float getAlpha();
+
+        //Gets time thrown away to keep slow frames from snowballing
+        Uint64 getDroppedNS();
+
+        //Gets the simulated time per step and the steps run so far
+        Uint64 getStepNS();
+        Uint32 getStepCount();
+
+    private:
+        //Clock frame times are read from
+        LTimer mClock;
+
+        //Time per step and the last clock reading
+        Uint64 mStepNs;
+        Uint64 mLastTicks;
+
+        //Time not yet simulated
+        Uint64 mAccumulatorNs;
+
+        //Time dropped by the catch up clamp
+        Uint64 mDroppedNs;
+
+        //Steps run since start
+        Uint32 mStepCount;
+};
+
+class LFrameGovernor
+{
+    public:
+        //Frame rates the governor picks between
+        enum class eTarget
+        {
+            Full,
+            Half,
+            Quarter,
+            Idle
+        };
+
+        //How long input keeps full rate and screen changes keep half rate
+        static constexpr Uint64 kInputHoldNS = 250000000;
+        static constexpr Uint64 kDirtyHoldNS = 1000000000;
+
+        //Quiet time before going idle
+        static constexpr Uint64 kIdleAfterNS = 3000000000;
+
+        //Longest wait while idle, events end it early
+        static constexpr Uint64 kIdlePeriodNS = 1000000000;
+
+        //Initializes variables
+        LFrameGovernor();
+
+        //Starts governing with the full frame rate
+        void start( int fullRate );
+
+        //Input arrived, full rate resumes on the next frame
+        void noteInput();
+
+        //Something on screen changed
+        void noteDirty();
+
+        //Takes this frame's scene activity and picks the target rate
+        void update( bool animating );
+
+        //Gets the chosen target
+        eTarget getTarget();
+        const char* getTargetName();
+
+        //Gets the frame period the pacer should hold
+        Uint64 getPeriodNS();
+
+        //Checks if the frame needs drawing, and marks it drawn
+        bool shouldRender();
+        void rendered();
+
+    private:
+        //Time since the last input and the last screen change
+        LTimer mInputTimer;
+        LTimer mDirtyTimer;
+
+        //Current target and full rate period
+        eTarget mTarget;
+        Uint64 mFullPeriodNs;
+
+        //Set when what's on screen is out of date
+        bool mNeedsRender;
+};
+
+//One finished profiling zone in performance counter ticks
+struct LProfileZone
+{
+    const char* name;
+    Uint64 startTicks;
+    Uint64 endTicks;
+};
+
+//Ring of zones written by a single thread
+struct LProfileBuffer
+{
+    SDL_ThreadID threadId;
+    std::unique_ptr<LProfileZone[]> zones;
+    Uint64 written;
+};
+
+class LProfiler
+{
+    public:
+        //Zones kept per thread before the oldest are overwritten
+        static constexpr int kZonesPerThread = 1 << 16;
+
+        //Initializes variables
+        LProfiler();
+
+        //Turns zone recording on or off
+        void setEnabled( bool enabled );
+        bool isEnabled();
+
+        //Stores a finished zone in the calling thread's ring
+        void record( const char* name, Uint64 startTicks, Uint64 endTicks );
+
+        //Writes every thread's zones as Chrome trace JSON, call once other threads are idle
+        bool writeChromeTrace( std::string path );
+
+        //Frees recorded zones
+        void destroy();
+
+    private:
+        //Gets the calling thread's ring, creating it on first use
+        LProfileBuffer* getThreadBuffer();
+
+        //Checked before any clock read so disabled zones cost a branch
+        bool mEnabled;
+
+        //Guards the buffer list, only taken the first time a thread records
+        SDL_Mutex* mMutex;
+        std::vector<std::unique_ptr<LProfileBuffer>> mBuffers;
+
+        //Bumped by destroy so threads drop their cached ring
+        SDL_AtomicInt mGeneration;
+};
+
+class LProfileScope
+{
+    public:
+        //Starts a zone, name must outlive the profiler
+        explicit LProfileScope( const char* name );
+
+        //Ends the zone
+        ~LProfileScope();
+
+    private:
+        //Zone name, null when profiling was off at the start
+        const char* mName;
+
+        //Performance counter at the start
+        Uint64 mStartTicks;
+};
+
+//Kinds of input latency is tracked for
+enum class eInputType
+{
+    Key = 0,
+    MouseMotion = 1,
+    MouseButton = 2,
+    Count = 3
+};
+
+class LInputLatency
+{
+    public:
+        //Latencies kept per input type
+        static constexpr int kSamples = 1024;
+
+        //State changes waiting for a present per input type
+        static constexpr int kMaxPending = 64;
+
+        //Initializes variables
+        LInputLatency();
+
+        //Marks a state change caused by an event with that event's timestamp
+        void tag( eInputType type, Uint64 eventTimestampNs );
+
+        //Records the time from each tagged event to now, call right after SDL_RenderPresent returns
+        void presented();
+
+        //Logs the latency distribution for each input type
+        void report();
+
+    private:
+        //Timestamps of state changes not presented yet
+        Uint64 mPending[ static_cast<int>( eInputType::Count ) ][ kMaxPending ];
+        int mPendingCount[ static_cast<int>( eInputType::Count ) ];
+
+        //Recent latencies, ring per input type
+        Uint64 mSamples[ static_cast<int>( eInputType::Count ) ][ kSamples ];
+        int mSampleCount[ static_cast<int>( eInputType::Count ) ];
+        int mNextSample[ static_cast<int>( eInputType::Count ) ];
+};
+
+class LInputRecorder
+{
+    public:
+        //Input log identification
+        static constexpr Uint32 kMagic = 0x504E494C;
+        static constexpr Uint32 kVersion = 2;
+
+        //Initializes variables
+        LInputRecorder();
+
+        //Stops the writer
+        ~LInputRecorder();
+
+        //Opens an input log and starts the thread writing it
+        bool start( std::string path );
+
+        //Writes the queued frames and closes the log
+        void stop();
+
+        //Checks if input is being recorded
+        bool isRecording();
+
+        //Appends a polled event to the current frame
+        void recordEvent( const SDL_Event& e );
+
+        //Hands the frame's events to the writer, the next frame's input goes in before the given simulation step
+        void endFrame( Uint32 nextStep );
+
+        //Gets how many bytes of an event a log entry keeps, 0 for anything but replayable input
+        static Uint16 getEventSize( Uint32 type );
+
+    private:
+        //Writer thread entry point
+        static int writerMain( void* data );
+
+        //Appends raw bytes of a value
+        template<typename T>
+        void write( const T& value );
+
+        //Log file
+        SDL_IOStream* mFile;
+
+        //Bytes of the frame being recorded, filled frames waiting to be written and emptied buffers to reuse
+        std::vector<Uint8> mFrameBuffer;
+        std::deque<std::vector<Uint8>> mPendingBuffers;
+        std::vector<std::vector<Uint8>> mFreeBuffers;
+
+        //Writer thread and its synchronization
+        SDL_Thread* mWriter;
+        SDL_Mutex* mMutex;
+        SDL_Condition* mWorkReady;
+        bool mQuit;
+
+        //Simulation step this frame's input goes in before and gClock time when recording started
+        Uint32 mStep;
+        Uint64 mStartNS;
+
+        //Event counters
+        Uint64 mRecordedEvents;
+        Uint64 mSkippedEvents;
+};
+
+class LInputReplayer
+{
+    public:
+        //Marks pushed events in their reserved field to tell them from live input
+        static constexpr Uint32 kReplayTag = 0x59504552;
+
+        //Initializes variables
+        LInputReplayer();
+
+        //Reads a whole input log into memory
+        bool load( std::string path );
+
+        //Checks if a log is loaded
+        bool isReplaying();
+
+        //Checks if every logged event has been pushed
+        bool isFinished();
+
+        //Pushes the events logged up to the given simulation step, call before polling
+        void pushFrameEvents( Uint32 step );
+
+        //Checks if a polled event is live input that would make the replay diverge
+        bool isLiveInput( const SDL_Event& e );
+
+    private:
+        //Reads raw bytes of a value, false at end of log
+        template<typename T>
+        bool read( T& value );
+
+        //The log contents and read position
+        std::vector<Uint8> mLog;
+        size_t mPosition;
+
+        //Entry read but waiting for its step
+        Uint32 mNextStep;
+        Uint64 mNextOffsetNS;
+        SDL_Event mNextEvent;
+        bool mHasNext;
+
+        //Whether anything was pushed yet and gClock time when the first frame was pushed
+        bool mStarted;
+        Uint64 mStartNS;
+};
+
 
 class LButton
 {
@@ -179,189 +754,1302 @@ private:
 
 
 
-/* Global Variables */
-//The window we'll be rendering to
-SDL_Window* gWindow{ nullptr };
+/* Global Variables */
+//The window we'll be rendering to
+SDL_Window* gWindow{ nullptr };
+
+//The renderer used to draw to the window
+SDL_Renderer* gRenderer{ nullptr };
+
+//Global font
+TTF_Font* gFont{ nullptr };
+
+//The directional images
+LTexture gDotTexture;
+
+//CPU profiling zones, enabled with --trace FILE
+LProfiler gProfiler;
+std::string gTracePath;
+
+//Time from input to the frame showing it
+LInputLatency gInputLatency;
+
+//Polled events written with --record-input and pushed back with --replay-input
+LInputRecorder gInputRecorder;
+LInputReplayer gInputReplayer;
+const char* gRecordInputPath{ nullptr };
+const char* gReplayInputPath{ nullptr };
+
+//Wall clock, used directly by anything measuring real cost
+LRealClock gRealClock;
+
+//Clock timers and pacers read, picked with --clock real|scaled|stepped and --time-scale
+LClock* gClock{ &gRealClock };
+
+//Runs without a display on the stepped clock for a set number of frames
+bool gHeadless{ false };
+int gHeadlessFrames{ kDefaultHeadlessFrames };
+
+
+
+/* Class Implementations */
+//Dot Implementation
+Dot::Dot():
+    mPosX{ 0.f },
+    mPosY{ 0.f },
+    mPrevPosX{ 0.f },
+    mPrevPosY{ 0.f },
+    mVelX{ 0.f },
+    mVelY{ 0.f }
+{
+
+}
+
+void Dot::handleActions( const LInputActions& actions )
+{
+    //Velocity before the update
+    float velX{ mVelX }, velY{ mVelY };
+
+    //Head where the held keys point
+    mVelX = actions.getAxis( eAxis::MoveX ) * kDotVel;
+    mVelY = actions.getAxis( eAxis::MoveY ) * kDotVel;
+
+    //Track latency for input that changed where the dot is going, nobody waits on replayed input
+    if( ( mVelX != velX || mVelY != velY ) && gInputReplayer.isReplaying() == false )
+    {
+        gInputLatency.tag( eInputType::Key, actions.getChangeTimestamp() );
+    }
+}
+
+void Dot::move( float stepSeconds )
+{
+    LProfileScope zone{ "Dot::move" };
+
+    //Remember where the step started for interpolation
+    mPrevPosX = mPosX;
+    mPrevPosY = mPosY;
+
+    //Move the dot left or right
+    mPosX += mVelX * stepSeconds;
+
+    //If the dot went too far to the left or right
+    if( ( mPosX < 0 ) || ( mPosX + kDotWidth > kScreenWidth ) )
+    {
+        //Move back
+        mPosX -= mVelX * stepSeconds;
+    }
+
+    //Move the dot up or down
+    mPosY += mVelY * stepSeconds;
+
+    //If the dot went too far up or down
+    if( ( mPosY < 0 ) || ( mPosY + kDotHeight > kScreenHeight ) )
+    {
+        //Move back
+        mPosY -= mVelY * stepSeconds;
+    }
+}
+
+bool Dot::isMoving()
+{
+    return mVelX != 0.f || mVelY != 0.f;
+}
+
+float Dot::getPosX()
+{
+    return mPosX;
+}
+
+float Dot::getPosY()
+{
+    return mPosY;
+}
+
+void Dot::render( float alpha )
+{
+    //Show the dot where it is between steps
+    gDotTexture.render( mPrevPosX + ( mPosX - mPrevPosX ) * alpha, mPrevPosY + ( mPosY - mPrevPosY ) * alpha );
+}
+
+
+//LClock Implementation
+bool LClock::isVirtual()
+{
+    return false;
+}
+
+
+//LRealClock Implementation
+Uint64 LRealClock::getTicksNS()
+{
+    return SDL_GetTicksNS();
+}
+
+void LRealClock::delayNS( Uint64 ns )
+{
+    SDL_DelayNS( ns );
+}
+
+
+//LScaledClock Implementation
+LScaledClock::LScaledClock( LClock& source, double scale ):
+    mSource( source ),
+    mScale{ scale },
+    mSourceAnchor{ source.getTicksNS() },
+    mTicksAnchor{ 0 }
+{
+
+}
+
+void LScaledClock::setScale( double scale )
+{
+    //Keep the time so far and scale from here on
+    mTicksAnchor = getTicksNS();
+    mSourceAnchor = mSource.getTicksNS();
+    mScale = scale;
+}
+
+double LScaledClock::getScale()
+{
+    return mScale;
+}
+
+Uint64 LScaledClock::getTicksNS()
+{
+    return mTicksAnchor + static_cast<Uint64>( ( mSource.getTicksNS() - mSourceAnchor ) * mScale );
+}
+
+void LScaledClock::delayNS( Uint64 ns )
+{
+    mSource.delayNS( static_cast<Uint64>( ns / mScale ) );
+}
+
+
+//LSteppedClock Implementation
+LSteppedClock::LSteppedClock():
+    mTicks{ 0 }
+{
+
+}
+
+void LSteppedClock::step( Uint64 ns )
+{
+    mTicks += ns;
+}
+
+Uint64 LSteppedClock::getTicksNS()
+{
+    return mTicks;
+}
+
+void LSteppedClock::delayNS( Uint64 ns )
+{
+    //Nothing to wait for, the wait is over as soon as time says so
+    mTicks += ns;
+}
+
+bool LSteppedClock::isVirtual()
+{
+    return true;
+}
+
+
+//LTimer Implementation
+LTimer::LTimer( LClock* clock ):
+    mClock{ clock },
+    mStartTicks{ 0 },
+    mPausedTicks{ 0 },
+
+    mPaused{ false },
+    mStarted{ false }
+{
+
+}
+
+void LTimer::start()
+{
+    //Start the timer
+    mStarted = true;
+
+    //Unpause the timer
+    mPaused = false;
+
+    //Get the current clock time
+    mStartTicks = getClock()->getTicksNS();
+    mPausedTicks = 0;
+}
+
+void LTimer::stop()
+{
+    //Stop the timer
+    mStarted = false;
+
+    //Unpause the timer
+    mPaused = false;
+
+    //Clear tick variables
+    mStartTicks = 0;
+    mPausedTicks = 0;
+}
+
+void LTimer::pause()
+{
+    //If the timer is running and isn't already paused
+    if( mStarted && !mPaused )
+    {
+        //Pause the timer
+        mPaused = true;
+
+        //Calculate the paused ticks
+        mPausedTicks = getClock()->getTicksNS() - mStartTicks;
+        mStartTicks = 0;
+    }
+}
+
+void LTimer::unpause()
+{
+    //If the timer is running and paused
+    if( mStarted && mPaused )
+    {
+        //Unpause the timer
+        mPaused = false;
+
+        //Reset the starting ticks
+        mStartTicks = getClock()->getTicksNS() - mPausedTicks;
+
+        //Reset the paused ticks
+        mPausedTicks = 0;
+    }
+}
+
+Uint64 LTimer::getTicksNS()
+{
+    //The actual timer time
+    Uint64 time{ 0 };
+
+    //If the timer is running
+    if( mStarted )
+    {
+        //If the timer is paused
+        if( mPaused )
+        {
+            //Return the number of ticks when the timer was paused
+            time = mPausedTicks;
+        }
+        else
+        {
+            //Return the current time minus the start time
+            time = getClock()->getTicksNS() - mStartTicks;
+        }
+    }
+
+    return time;
+}
+
+bool LTimer::isPaused() 
+{
+    return mPaused;
+}
+
+bool LTimer::isStarted()
+{
+    return mStarted;
+}
+
+LClock* LTimer::getClock()
+{
+    return mClock != nullptr ? mClock : gClock;
+}
+
+//LFramePacer Implementation
+LFramePacer::LFramePacer():
+    mPeriodNs{ 0 },
+    mDeadlineNs{ 0 },
+    mSpinMarginNs{ 2000000 },
+    mPacing{ ePacing::Hybrid },
+    mWakeOnEvent{ false },
+    mErrors{},
+    mErrorCount{ 0 },
+    mNextError{ 0 }
+{
+
+}
+
+void LFramePacer::start( Uint64 periodNs, ePacing pacing )
+{
+    //Deadlines are absolute so late frames don't push later ones back
+    mPeriodNs = periodNs;
+    mDeadlineNs = periodNs;
+    mPacing = pacing;
+    clearStatistics();
+    mClock.start();
+}
+
+void LFramePacer::wait()
+{
+    Uint64 now{ mClock.getTicksNS() };
+    if( now < mDeadlineNs )
+    {
+        //Sleep through most of the wait, hybrid pacing stops early enough to absorb oversleep
+        Uint64 margin{ mPacing == ePacing::Hybrid ? mSpinMarginNs : 0 };
+        if( mDeadlineNs - now > margin )
+        {
+            Uint64 requestedNs{ mDeadlineNs - now - margin };
+            //Event waits only run in real time, other clocks sleep through the whole wait
+            if( mWakeOnEvent && requestedNs >= 1000000 && mClock.getClock() == &gRealClock )
+            {
+                //Start the next frame as soon as an event is queued, leaving it in the queue
+                if( SDL_WaitEventTimeout( nullptr, static_cast<Sint32>( requestedNs / 1000000 ) ) )
+                {
+                    mDeadlineNs = mClock.getTicksNS() + mPeriodNs;
+                    return;
+                }
+            }
+            else
+            {
+                mClock.getClock()->delayNS( requestedNs );
+            }
+            Uint64 woke{ mClock.getTicksNS() };
+
+            //Track oversleep, jump up to a new worst case and slowly come back down
+            Uint64 oversleepNs{ woke - now > requestedNs ? woke - now - requestedNs : 0 };
+            if( oversleepNs > mSpinMarginNs )
+            {
+                mSpinMarginNs = oversleepNs + oversleepNs / 4;
+            }
+            else
+            {
+                mSpinMarginNs -= ( mSpinMarginNs - oversleepNs ) / 64;
+            }
+            mSpinMarginNs = SDL_clamp( mSpinMarginNs, kMinSpinMarginNS, kMaxSpinMarginNS );
+            now = woke;
+        }
+
+        //Spin out the rest, virtual clocks only move when waited on
+        if( mClock.getClock()->isVirtual() )
+        {
+            mClock.getClock()->delayNS( mDeadlineNs - now );
+            now = mClock.getTicksNS();
+        }
+        while( now < mDeadlineNs )
+        {
+            SDL_CPUPauseInstruction();
+            now = mClock.getTicksNS();
+        }
+    }
+
+    addSample( now - mDeadlineNs );
+
+    //Next deadline, resync instead of rushing frames to catch up if more than a frame behind
+    mDeadlineNs += mPeriodNs;
+    if( now >= mDeadlineNs )
+    {
+        mDeadlineNs = now + mPeriodNs;
+    }
+}
+
+void LFramePacer::setPacing( ePacing pacing )
+{
+    mPacing = pacing;
+    clearStatistics();
+}
+
+LFramePacer::ePacing LFramePacer::getPacing()
+{
+    return mPacing;
+}
+
+Uint64 LFramePacer::getMeanErrorNS()
+{
+    if( mErrorCount == 0 )
+    {
+        return 0;
+    }
+
+    Uint64 sum{ 0 };
+    for( int i = 0; i < mErrorCount; ++i )
+    {
+        sum += mErrors[ i ];
+    }
+    return sum / mErrorCount;
+}
+
+Uint64 LFramePacer::getP99ErrorNS()
+{
+    if( mErrorCount == 0 )
+    {
+        return 0;
+    }
+
+    //Select on a copy so the ring keeps its order
+    Uint64 sorted[ kJitterSamples ];
+    std::copy( mErrors, mErrors + mErrorCount, sorted );
+    int index{ ( mErrorCount - 1 ) * 99 / 100 };
+    std::nth_element( sorted, sorted + index, sorted + mErrorCount );
+    return sorted[ index ];
+}
+
+int LFramePacer::getSampleCount()
+{
+    return mErrorCount;
+}
+
+void LFramePacer::report()
+{
+    SDL_Log( "Frame pacer (%s): %d frames, wakeup error mean %.3f ms p99 %.3f ms, spin margin %.3f ms\n",
+        mPacing == ePacing::Hybrid ? "hybrid" : "sleep", mErrorCount,
+        getMeanErrorNS() / 1000000.0, getP99ErrorNS() / 1000000.0, mSpinMarginNs / 1000000.0 );
+}
+
+void LFramePacer::clearStatistics()
+{
+    mErrorCount = 0;
+    mNextError = 0;
+}
+
+void LFramePacer::setPeriod( Uint64 periodNs )
+{
+    //Move the pending deadline so it sits the new period after the last one
+    mDeadlineNs = mDeadlineNs - mPeriodNs + periodNs;
+    mPeriodNs = periodNs;
+}
+
+void LFramePacer::setWakeOnEvent( bool wakeOnEvent )
+{
+    mWakeOnEvent = wakeOnEvent;
+}
+
+void LFramePacer::addSample( Uint64 errorNs )
+{
+    mErrors[ mNextError ] = errorNs;
+    mNextError = ( mNextError + 1 ) % kJitterSamples;
+    if( mErrorCount < kJitterSamples )
+    {
+        ++mErrorCount;
+    }
+}
+
+//LFixedTimestep Implementation
+LFixedTimestep::LFixedTimestep():
+    mStepNs{ 0 },
+    mLastTicks{ 0 },
+    mAccumulatorNs{ 0 },
+    mDroppedNs{ 0 },
+    mStepCount{ 0 }
+{
+
+}
+
+void LFixedTimestep::start( int stepsPerSecond )
+{
+    mStepNs = 1000000000 / stepsPerSecond;
+    mLastTicks = 0;
+    mAccumulatorNs = 0;
+    mDroppedNs = 0;
+    mStepCount = 0;
+    mClock.start();
+}
+
+void LFixedTimestep::beginFrame()
+{
+    //Bank the time since last frame
+    Uint64 ticks{ mClock.getTicksNS() };
+    mAccumulatorNs += ticks - mLastTicks;
+    mLastTicks = ticks;
+
+    //If the simulation can't keep up, drop time instead of running ever more steps per frame
+    const Uint64 maxAccumulatorNs{ mStepNs * kMaxCatchUpSteps };
+    if( mAccumulatorNs > maxAccumulatorNs )
+    {
+        mDroppedNs += mAccumulatorNs - maxAccumulatorNs;
+        mAccumulatorNs = maxAccumulatorNs;
+    }
+}
+
+bool LFixedTimestep::step()
+{
+    if( mAccumulatorNs < mStepNs )
+    {
+        return false;
+    }
+
+    mAccumulatorNs -= mStepNs;
+    ++mStepCount;
+    return true;
+}
+
+float LFixedTimestep::getStepSeconds()
+{
+    return static_cast<float>( mStepNs ) / 1000000000.f;
+}
+
+float LFixedTimestep::getAlpha()
+{
+    return static_cast<float>( mAccumulatorNs ) / static_cast<float>( mStepNs );
+}
+
+Uint64 LFixedTimestep::getDroppedNS()
+{
+    return mDroppedNs;
+}
+
+Uint64 LFixedTimestep::getStepNS()
+{
+    return mStepNs;
+}
+
+Uint32 LFixedTimestep::getStepCount()
+{
+    return mStepCount;
+}
+
+//LFrameGovernor Implementation
+LFrameGovernor::LFrameGovernor():
+    mTarget{ eTarget::Full },
+    mFullPeriodNs{ 0 },
+    mNeedsRender{ true }
+{
+
+}
+
+void LFrameGovernor::start( int fullRate )
+{
+    mFullPeriodNs = 1000000000 / fullRate;
+    mTarget = eTarget::Full;
+    mNeedsRender = true;
+    mInputTimer.start();
+    mDirtyTimer.start();
+}
+
+void LFrameGovernor::noteInput()
+{
+    mInputTimer.start();
+    mTarget = eTarget::Full;
+    mNeedsRender = true;
+}
+
+void LFrameGovernor::noteDirty()
+{
+    mDirtyTimer.start();
+    mNeedsRender = true;
+}
+
+void LFrameGovernor::update( bool animating )
+{
+    //Anything moving counts as a change this frame
+    if( animating )
+    {
+        noteDirty();
+    }
+
+    //Step down as the scene goes quiet
+    eTarget target{ eTarget::Idle };
+    if( animating || mInputTimer.getTicksNS() < kInputHoldNS )
+    {
+        target = eTarget::Full;
+    }
+    else if( mDirtyTimer.getTicksNS() < kDirtyHoldNS )
+    {
+        target = eTarget::Half;
+    }
+    else if( SDL_min( mInputTimer.getTicksNS(), mDirtyTimer.getTicksNS() ) < kIdleAfterNS )
+    {
+        target = eTarget::Quarter;
+    }
+
+    if( target != mTarget )
+    {
+        mTarget = target;
+        SDL_Log( "Frame governor: %s\n", getTargetName() );
+    }
+}
+
+LFrameGovernor::eTarget LFrameGovernor::getTarget()
+{
+    return mTarget;
+}
+
+const char* LFrameGovernor::getTargetName()
+{
+    switch( mTarget )
+    {
+        case eTarget::Full: return "full rate";
+        case eTarget::Half: return "half rate";
+        case eTarget::Quarter: return "quarter rate";
+        case eTarget::Idle: return "idle";
+    }
+    return "";
+}
+
+Uint64 LFrameGovernor::getPeriodNS()
+{
+    switch( mTarget )
+    {
+        case eTarget::Full: return mFullPeriodNs;
+        case eTarget::Half: return mFullPeriodNs * 2;
+        case eTarget::Quarter: return mFullPeriodNs * 4;
+        case eTarget::Idle: return kIdlePeriodNS;
+    }
+    return mFullPeriodNs;
+}
+
+bool LFrameGovernor::shouldRender()
+{
+    return mNeedsRender;
+}
+
+void LFrameGovernor::rendered()
+{
+    mNeedsRender = false;
+}
+
+//LProfiler Implementation
+LProfiler::LProfiler():
+    mEnabled{ false },
+    mMutex{ nullptr }
+{
+    SDL_SetAtomicInt( &mGeneration, 0 );
+}
+
+void LProfiler::setEnabled( bool enabled )
+{
+    if( enabled && mMutex == nullptr )
+    {
+        mMutex = SDL_CreateMutex();
+    }
+    mEnabled = enabled && mMutex != nullptr;
+}
+
+bool LProfiler::isEnabled()
+{
+    return mEnabled;
+}
+
+void LProfiler::record( const char* name, Uint64 startTicks, Uint64 endTicks )
+{
+    if( LProfileBuffer* buffer = getThreadBuffer(); buffer != nullptr )
+    {
+        //Only this thread writes its ring
+        buffer->zones[ buffer->written % kZonesPerThread ] = LProfileZone{ name, startTicks, endTicks };
+        ++buffer->written;
+    }
+}
+
+bool LProfiler::writeChromeTrace( std::string path )
+{
+    SDL_IOStream* file{ SDL_IOFromFile( path.c_str(), "w" ) };
+    if( file == nullptr )
+    {
+        SDL_Log( "Unable to open trace file %s! SDL error: %s\n", path.c_str(), SDL_GetError() );
+        return false;
+    }
+
+    //Times are microseconds from the first recorded zone
+    SDL_LockMutex( mMutex );
+    Uint64 firstTicks{ SDL_MAX_UINT64 };
+    for( auto& buffer : mBuffers )
+    {
+        Uint64 count{ SDL_min( buffer->written, static_cast<Uint64>( kZonesPerThread ) ) };
+        for( Uint64 i = buffer->written - count; i < buffer->written; ++i )
+        {
+            firstTicks = SDL_min( firstTicks, buffer->zones[ i % kZonesPerThread ].startTicks );
+        }
+    }
+    const double microsecondsPerTick{ 1000000.0 / static_cast<double>( SDL_GetPerformanceFrequency() ) };
+
+    //Complete events, the viewer nests them by time
+    SDL_IOprintf( file, "{\"traceEvents\":[" );
+    bool first{ true };
+    for( auto& buffer : mBuffers )
+    {
+        Uint64 count{ SDL_min( buffer->written, static_cast<Uint64>( kZonesPerThread ) ) };
+        for( Uint64 i = buffer->written - count; i < buffer->written; ++i )
+        {
+            const LProfileZone& zone{ buffer->zones[ i % kZonesPerThread ] };
+            SDL_IOprintf( file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",", zone.name, static_cast<unsigned long long>( buffer->threadId ),
+                ( zone.startTicks - firstTicks ) * microsecondsPerTick, ( zone.endTicks - zone.startTicks ) * microsecondsPerTick );
+            first = false;
+        }
+    }
+    SDL_IOprintf( file, "\n]}\n" );
+    SDL_UnlockMutex( mMutex );
+
+    return SDL_CloseIO( file );
+}
+
+void LProfiler::destroy()
+{
+    mEnabled = false;
+    SDL_AddAtomicInt( &mGeneration, 1 );
+    mBuffers.clear();
+    SDL_DestroyMutex( mMutex );
+    mMutex = nullptr;
+}
+
+LProfileBuffer* LProfiler::getThreadBuffer()
+{
+    //Threads find their own ring without locking after the first zone, until destroy frees it
+    static thread_local LProfileBuffer* threadBuffer{ nullptr };
+    static thread_local int threadGeneration{ 0 };
+    if( int generation = SDL_GetAtomicInt( &mGeneration ); threadGeneration != generation )
+    {
+        threadBuffer = nullptr;
+        threadGeneration = generation;
+    }
+    if( threadBuffer == nullptr && mMutex != nullptr )
+    {
+        auto buffer{ std::make_unique<LProfileBuffer>() };
+        buffer->threadId = SDL_GetCurrentThreadID();
+        buffer->zones = std::make_unique<LProfileZone[]>( kZonesPerThread );
+        buffer->written = 0;
+
+        SDL_LockMutex( mMutex );
+        threadBuffer = buffer.get();
+        mBuffers.push_back( std::move( buffer ) );
+        SDL_UnlockMutex( mMutex );
+    }
+    return threadBuffer;
+}
+
+
+//LProfileScope Implementation
+LProfileScope::LProfileScope( const char* name ):
+    mName{ gProfiler.isEnabled() ? name : nullptr },
+    mStartTicks{ mName != nullptr ? SDL_GetPerformanceCounter() : 0 }
+{
+
+}
+
+LProfileScope::~LProfileScope()
+{
+    if( mName != nullptr && gProfiler.isEnabled() )
+    {
+        gProfiler.record( mName, mStartTicks, SDL_GetPerformanceCounter() );
+    }
+}
+
+//LInputActions Implementation
+LInputActions::LInputActions():
+    mPressed{ 0 },
+    mReleased{ 0 },
+    mChangeTimestamp{ 0 }
+{
+    static_assert( kActionCount <= 32, "Action states are kept in 32 bit masks" );
+
+    SDL_memset( mScancodeActions, kUnbound, sizeof( mScancodeActions ) );
+    SDL_zeroa( mScancodeDown );
+    SDL_zeroa( mHeldKeys );
+    SDL_memset( mAxisNegative, kUnbound, sizeof( mAxisNegative ) );
+    SDL_memset( mAxisPositive, kUnbound, sizeof( mAxisPositive ) );
+}
+
+void LInputActions::bind( SDL_Scancode scancode, eAction action )
+{
+    if( scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_SCANCODE_COUNT )
+    {
+        rebindHeld( scancode, static_cast<Uint8>( action ) );
+        mScancodeActions[ scancode ] = static_cast<Uint8>( action );
+    }
+}
+
+void LInputActions::unbind( SDL_Scancode scancode )
+{
+    if( scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_SCANCODE_COUNT )
+    {
+        rebindHeld( scancode, kUnbound );
+        mScancodeActions[ scancode ] = kUnbound;
+    }
+}
+
+void LInputActions::bindAxis( eAxis axis, eAction negative, eAction positive )
+{
+    mAxisNegative[ static_cast<int>( axis ) ] = static_cast<Uint8>( negative );
+    mAxisPositive[ static_cast<int>( axis ) ] = static_cast<Uint8>( positive );
+}
+
+void LInputActions::beginFrame()
+{
+    mPressed = 0;
+    mReleased = 0;
+}
+
+void LInputActions::handleEvent( const SDL_Event& e )
+{
+    //Only key transitions change actions, repeats and keys outside the table are skipped
+    if( ( e.type != SDL_EVENT_KEY_DOWN && e.type != SDL_EVENT_KEY_UP ) || e.key.repeat || e.key.scancode <= SDL_SCANCODE_UNKNOWN || e.key.scancode >= SDL_SCANCODE_COUNT )
+    {
+        return;
+    }
+
+    //Ignore downs for keys already down and ups for keys already up
+    bool down{ e.type == SDL_EVENT_KEY_DOWN };
+    if( mScancodeDown[ e.key.scancode ] == down )
+    {
+        return;
+    }
+    mScancodeDown[ e.key.scancode ] = down;
+
+    //One table lookup finds the action
+    Uint8 action{ mScancodeActions[ e.key.scancode ] };
+    if( action == kUnbound )
+    {
+        return;
+    }
+
+    //Actions go down with their first key and up with their last
+    if( down )
+    {
+        if( mHeldKeys[ action ]++ == 0 )
+        {
+            mPressed |= 1u << action;
+            mChangeTimestamp = e.key.timestamp;
+        }
+    }
+    else if( --mHeldKeys[ action ] == 0 )
+    {
+        mReleased |= 1u << action;
+        mChangeTimestamp = e.key.timestamp;
+    }
+}
+
+bool LInputActions::isPressed( eAction action ) const
+{
+    return ( mPressed >> static_cast<int>( action ) ) & 1u;
+}
+
+bool LInputActions::isHeld( eAction action ) const
+{
+    return mHeldKeys[ static_cast<int>( action ) ] > 0;
+}
+
+bool LInputActions::isReleased( eAction action ) const
+{
+    return ( mReleased >> static_cast<int>( action ) ) & 1u;
+}
 
-//The renderer used to draw to the window
-SDL_Renderer* gRenderer{ nullptr };
+float LInputActions::getAxis( eAxis axis ) const
+{
+    Uint8 negative{ mAxisNegative[ static_cast<int>( axis ) ] };
+    Uint8 positive{ mAxisPositive[ static_cast<int>( axis ) ] };
+    float value{ 0.f };
+    if( negative != kUnbound && mHeldKeys[ negative ] > 0 )
+    {
+        value -= 1.f;
+    }
+    if( positive != kUnbound && mHeldKeys[ positive ] > 0 )
+    {
+        value += 1.f;
+    }
+    return value;
+}
 
-//Global font
-TTF_Font* gFont{ nullptr };
+Uint64 LInputActions::getChangeTimestamp() const
+{
+    return mChangeTimestamp;
+}
 
-//The directional images
-LTexture gDotTexture;
+void LInputActions::rebindHeld( SDL_Scancode scancode, Uint8 action )
+{
+    //Keys that are up hold nothing
+    Uint8 oldAction{ mScancodeActions[ scancode ] };
+    if( !mScancodeDown[ scancode ] || oldAction == action )
+    {
+        return;
+    }
 
+    //Let go of the old action and take hold of the new one without a new press
+    if( oldAction != kUnbound && --mHeldKeys[ oldAction ] == 0 )
+    {
+        mReleased |= 1u << oldAction;
+    }
+    if( action != kUnbound )
+    {
+        mHeldKeys[ action ]++;
+    }
+}
 
 
-/* Class Implementations */
-//Dot Implementation
-Dot::Dot():
-    mPosX{ 0 },
-    mPosY{ 0 },
-    mVelX{ 0 },
-    mVelY{ 0 }
+//LInputLatency Implementation
+LInputLatency::LInputLatency():
+    mPending{},
+    mPendingCount{},
+    mSamples{},
+    mSampleCount{},
+    mNextSample{}
 {
 
 }
 
-void Dot::handleEvent( SDL_Event& e )
+void LInputLatency::tag( eInputType type, Uint64 eventTimestampNs )
+{
+    //One event changing several things counts once, past the limit the oldest pending changes already give the worst case
+    int t{ static_cast<int>( type ) };
+    bool repeated{ mPendingCount[ t ] > 0 && mPending[ t ][ mPendingCount[ t ] - 1 ] == eventTimestampNs };
+    if( repeated == false && mPendingCount[ t ] < kMaxPending )
+    {
+        mPending[ t ][ mPendingCount[ t ]++ ] = eventTimestampNs;
+    }
+}
+
+void LInputLatency::presented()
 {
-    //If a key was pressed
-    if( e.type == SDL_EVENT_KEY_DOWN && e.key.repeat == 0 )
+    //Event timestamps come from the same clock as SDL_GetTicksNS
+    Uint64 now{ SDL_GetTicksNS() };
+    for( int t = 0; t < static_cast<int>( eInputType::Count ); ++t )
     {
-        //Adjust the velocity
-        switch( e.key.key )
+        for( int i = 0; i < mPendingCount[ t ]; ++i )
         {
-            case SDLK_UP: mVelY -= kDotVel; break;
-            case SDLK_DOWN: mVelY += kDotVel; break;
-            case SDLK_LEFT: mVelX -= kDotVel; break;
-            case SDLK_RIGHT: mVelX += kDotVel; break;
+            mSamples[ t ][ mNextSample[ t ] ] = now > mPending[ t ][ i ] ? now - mPending[ t ][ i ] : 0;
+            mNextSample[ t ] = ( mNextSample[ t ] + 1 ) % kSamples;
+            mSampleCount[ t ] = SDL_min( mSampleCount[ t ] + 1, kSamples );
         }
+        mPendingCount[ t ] = 0;
     }
-    //If a key was released
-    else if( e.type == SDL_EVENT_KEY_UP && e.key.repeat == 0 )
+}
+
+void LInputLatency::report()
+{
+    const char* names[ static_cast<int>( eInputType::Count ) ]{ "key", "mouse motion", "mouse button" };
+    for( int t = 0; t < static_cast<int>( eInputType::Count ); ++t )
     {
-        //Adjust the velocity
-        switch( e.key.key )
+        int count{ mSampleCount[ t ] };
+        if( count == 0 )
         {
-            case SDLK_UP: mVelY += kDotVel; break;
-            case SDLK_DOWN: mVelY -= kDotVel; break;
-            case SDLK_LEFT: mVelX += kDotVel; break;
-            case SDLK_RIGHT: mVelX -= kDotVel; break;
+            continue;
         }
+
+        //Sort a copy for percentiles
+        Uint64 sorted[ kSamples ];
+        std::copy( mSamples[ t ], mSamples[ t ] + count, sorted );
+        std::sort( sorted, sorted + count );
+        SDL_Log( "Input to present latency, %s: %d samples, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\n", names[ t ], count,
+            sorted[ ( count - 1 ) * 50 / 100 ] / 1000000.0, sorted[ ( count - 1 ) * 95 / 100 ] / 1000000.0,
+            sorted[ ( count - 1 ) * 99 / 100 ] / 1000000.0, sorted[ count - 1 ] / 1000000.0 );
     }
 }
 
-void Dot::move()
+//LInputRecorder Implementation
+LInputRecorder::LInputRecorder():
+    mFile{ nullptr },
+    mWriter{ nullptr },
+    mMutex{ nullptr },
+    mWorkReady{ nullptr },
+    mQuit{ false },
+    mStep{ 0 },
+    mStartNS{ 0 },
+    mRecordedEvents{ 0 },
+    mSkippedEvents{ 0 }
 {
-    //Move the dot left or right
-    mPosX += mVelX;
 
-    //If the dot went too far to the left or right
-    if( ( mPosX < 0 ) || ( mPosX + kDotWidth > kScreenWidth ) )
+}
+
+LInputRecorder::~LInputRecorder()
+{
+    stop();
+}
+
+bool LInputRecorder::start( std::string path )
+{
+    //Stop old recording
+    stop();
+
+    //Open log file
+    if( mFile = SDL_IOFromFile( path.c_str(), "wb" ); mFile == nullptr )
     {
-        //Move back
-        mPosX -= mVelX;
+        SDL_Log( "Unable to open input log %s! SDL error: %s\n", path.c_str(), SDL_GetError() );
+        return false;
     }
 
-    //Move the dot up or down
-    mPosY += mVelY;
-
-    //If the dot went too far up or down
-    if( ( mPosY < 0 ) || ( mPosY + kDotHeight > kScreenHeight ) )
+    //Write header, the event size guards against replaying with a different SDL
+    mFrameBuffer.reserve( 1 << 12 );
+    write( kMagic );
+    write( kVersion );
+    write( static_cast<Uint32>( sizeof( SDL_Event ) ) );
+
+    //Start writer
+    mMutex = SDL_CreateMutex();
+    mWorkReady = SDL_CreateCondition();
+    mQuit = false;
+    mStep = 0;
+    mStartNS = gClock->getTicksNS();
+    mRecordedEvents = 0;
+    mSkippedEvents = 0;
+    if( mWriter = SDL_CreateThread( writerMain, "InputWriter", this ); mWriter == nullptr )
     {
-        //Move back
-        mPosY -= mVelY;
+        SDL_Log( "Unable to create input writer! SDL error: %s\n", SDL_GetError() );
+        stop();
+        return false;
     }
+
+    return true;
 }
 
-void Dot::render()
+void LInputRecorder::stop()
 {
-    //Show the dot
-    gDotTexture.render( static_cast<float>( mPosX ), static_cast<float>( mPosY ) );
-}
+    if( mFile == nullptr )
+    {
+        return;
+    }
 
+    //Queue the last partial frame and let the writer finish the queue
+    if( mWriter != nullptr )
+    {
+        endFrame( mStep );
+        SDL_LockMutex( mMutex );
+        mQuit = true;
+        SDL_SignalCondition( mWorkReady );
+        SDL_UnlockMutex( mMutex );
+        SDL_WaitThread( mWriter, nullptr );
+        mWriter = nullptr;
+
+        SDL_Log( "Input recording: %d steps, %d events, %d skipped\n", static_cast<int>( mStep ), static_cast<int>( mRecordedEvents ), static_cast<int>( mSkippedEvents ) );
+    }
 
-//LTimer Implementation
-LTimer::LTimer():
-    mStartTicks{ 0 },
-    mPausedTicks{ 0 },
+    //Free synchronization objects and buffers
+    SDL_DestroyCondition( mWorkReady );
+    mWorkReady = nullptr;
+    SDL_DestroyMutex( mMutex );
+    mMutex = nullptr;
+    SDL_CloseIO( mFile );
+    mFile = nullptr;
+    mFrameBuffer.clear();
+    mPendingBuffers.clear();
+    mFreeBuffers.clear();
+}
 
-    mPaused{ false },
-    mStarted{ false }
+bool LInputRecorder::isRecording()
 {
-
+    return mFile != nullptr;
 }
 
-void LTimer::start()
+void LInputRecorder::recordEvent( const SDL_Event& e )
 {
-    //Start the timer
-    mStarted = true;
+    //Only input events can be replayed
+    Uint16 size{ getEventSize( e.type ) };
+    if( size == 0 )
+    {
+        mSkippedEvents++;
+        return;
+    }
 
-    //Unpause the timer
-    mPaused = false;
+    //Entry: simulation step, clock time since recording started, event size and the event's leading bytes
+    write( mStep );
+    write( gClock->getTicksNS() - mStartNS );
+    write( size );
+    const Uint8* bytes{ reinterpret_cast<const Uint8*>( &e ) };
+    mFrameBuffer.insert( mFrameBuffer.end(), bytes, bytes + size );
+    mRecordedEvents++;
+}
 
-    //Get the current clock time
-    mStartTicks = SDL_GetTicksNS();
-    mPausedTicks = 0;
+void LInputRecorder::endFrame( Uint32 nextStep )
+{
+    //Frames without input cost nothing in the log
+    mStep = nextStep;
+    if( mFrameBuffer.empty() )
+    {
+        return;
+    }
+
+    //Swap the frame's bytes for a recycled buffer so the main thread never waits on the disk
+    SDL_LockMutex( mMutex );
+    mPendingBuffers.push_back( std::move( mFrameBuffer ) );
+    if( mFreeBuffers.empty() )
+    {
+        mFrameBuffer = std::vector<Uint8>();
+    }
+    else
+    {
+        mFrameBuffer = std::move( mFreeBuffers.back() );
+        mFreeBuffers.pop_back();
+    }
+    SDL_SignalCondition( mWorkReady );
+    SDL_UnlockMutex( mMutex );
 }
 
-void LTimer::stop()
+Uint16 LInputRecorder::getEventSize( Uint32 type )
 {
-    //Stop the timer
-    mStarted = false;
+    switch( type )
+    {
+        //Input events only keep their own struct
+        case SDL_EVENT_QUIT:
+            return sizeof( SDL_QuitEvent );
+        case SDL_EVENT_KEY_DOWN:
+        case SDL_EVENT_KEY_UP:
+            return sizeof( SDL_KeyboardEvent );
+        case SDL_EVENT_MOUSE_MOTION:
+            return sizeof( SDL_MouseMotionEvent );
+        case SDL_EVENT_MOUSE_BUTTON_DOWN:
+        case SDL_EVENT_MOUSE_BUTTON_UP:
+            return sizeof( SDL_MouseButtonEvent );
+        case SDL_EVENT_MOUSE_WHEEL:
+            return sizeof( SDL_MouseWheelEvent );
+    }
 
-    //Unpause the timer
-    mPaused = false;
+    //Window events share one struct, pointers and device or renderer events can't be faked by a replay
+    if( type >= SDL_EVENT_WINDOW_FIRST && type <= SDL_EVENT_WINDOW_LAST )
+    {
+        return sizeof( SDL_WindowEvent );
+    }
+    return 0;
+}
 
-    //Clear tick variables
-    mStartTicks = 0;
-    mPausedTicks = 0;
+template<typename T>
+void LInputRecorder::write( const T& value )
+{
+    const Uint8* bytes{ reinterpret_cast<const Uint8*>( &value ) };
+    mFrameBuffer.insert( mFrameBuffer.end(), bytes, bytes + sizeof( T ) );
 }
 
-void LTimer::pause()
+int LInputRecorder::writerMain( void* data )
 {
-    //If the timer is running and isn't already paused
-    if( mStarted && !mPaused )
+    LInputRecorder* recorder{ static_cast<LInputRecorder*>( data ) };
+
+    SDL_LockMutex( recorder->mMutex );
+    while( true )
     {
-        //Pause the timer
-        mPaused = true;
+        //Wait for a frame, exiting only once the queue is empty
+        while( recorder->mPendingBuffers.empty() && recorder->mQuit == false )
+        {
+            SDL_WaitCondition( recorder->mWorkReady, recorder->mMutex );
+        }
+        if( recorder->mPendingBuffers.empty() )
+        {
+            break;
+        }
+        std::vector<Uint8> buffer{ std::move( recorder->mPendingBuffers.front() ) };
+        recorder->mPendingBuffers.pop_front();
 
-        //Calculate the paused ticks
-        mPausedTicks = SDL_GetTicksNS() - mStartTicks;
-        mStartTicks = 0;
+        //Write without holding the lock
+        SDL_UnlockMutex( recorder->mMutex );
+        if( SDL_WriteIO( recorder->mFile, buffer.data(), buffer.size() ) != buffer.size() )
+        {
+            SDL_Log( "Unable to write input log! SDL error: %s\n", SDL_GetError() );
+        }
+        buffer.clear();
+        SDL_LockMutex( recorder->mMutex );
+
+        //Return buffer for reuse
+        recorder->mFreeBuffers.push_back( std::move( buffer ) );
     }
+    SDL_UnlockMutex( recorder->mMutex );
+
+    return 0;
 }
 
-void LTimer::unpause()
+
+//LInputReplayer Implementation
+LInputReplayer::LInputReplayer():
+    mPosition{ 0 },
+    mNextStep{ 0 },
+    mNextOffsetNS{ 0 },
+    mHasNext{ false },
+    mStarted{ false },
+    mStartNS{ 0 }
 {
-    //If the timer is running and paused
-    if( mStarted && mPaused )
+    SDL_zero( mNextEvent );
+}
+
+bool LInputReplayer::load( std::string path )
+{
+    //Read whole log
+    size_t size{ 0 };
+    void* data{ SDL_LoadFile( path.c_str(), &size ) };
+    if( data == nullptr )
     {
-        //Unpause the timer
-        mPaused = false;
+        SDL_Log( "Unable to load input log %s! SDL error: %s\n", path.c_str(), SDL_GetError() );
+        return false;
+    }
+    mLog.assign( static_cast<Uint8*>( data ), static_cast<Uint8*>( data ) + size );
+    SDL_free( data );
+    mPosition = 0;
+
+    //Check header
+    Uint32 magic{ 0 }, version{ 0 }, eventSize{ 0 };
+    if( read( magic ) == false || read( version ) == false || read( eventSize ) == false ||
+        magic != LInputRecorder::kMagic || version != LInputRecorder::kVersion || eventSize != sizeof( SDL_Event ) )
+    {
+        SDL_Log( "%s is not a compatible input log!\n", path.c_str() );
+        mLog.clear();
+        return false;
+    }
 
-        //Reset the starting ticks
-        mStartTicks = SDL_GetTicksNS() - mPausedTicks;
+    //Entries are read as their steps come up, timed from the first frame pushed
+    SDL_zero( mNextEvent );
+    mHasNext = true;
+    mStarted = false;
+    mStartNS = 0;
+    return true;
+}
 
-        //Reset the paused ticks
-        mPausedTicks = 0;
-    }
+bool LInputReplayer::isReplaying()
+{
+    return mLog.empty() == false;
 }
 
-Uint64 LTimer::getTicksNS()
+bool LInputReplayer::isFinished()
 {
-    //The actual timer time
-    Uint64 time{ 0 };
+    return mHasNext == false;
+}
 
-    //If the timer is running
-    if( mStarted )
+void LInputReplayer::pushFrameEvents( Uint32 step )
+{
+    //Replay time starts with the first replayed frame, not when the log was loaded
+    if( mStarted == false )
     {
-        //If the timer is paused
-        if( mPaused )
+        mStartNS = gClock->getTicksNS();
+        mStarted = true;
+    }
+
+    while( mHasNext )
+    {
+        //Read the next entry unless it is waiting for a later step
+        if( mNextEvent.type == 0 )
         {
-            //Return the number of ticks when the timer was paused
-            time = mPausedTicks;
+            Uint16 size{ 0 };
+            if( read( mNextStep ) == false || read( mNextOffsetNS ) == false || read( size ) == false ||
+                size > sizeof( SDL_Event ) || mPosition + size > mLog.size() )
+            {
+                mHasNext = false;
+                break;
+            }
+            SDL_zero( mNextEvent );
+            SDL_memcpy( &mNextEvent, mLog.data() + mPosition, size );
+            mPosition += size;
         }
-        else
+        if( mNextStep > step )
         {
-            //Return the current time minus the start time
-            time = SDL_GetTicksNS() - mStartTicks;
+            break;
         }
-    }
 
-    return time;
+        //Push with the recorded spacing rebased onto gClock
+        mNextEvent.common.timestamp = mStartNS + mNextOffsetNS;
+        mNextEvent.common.reserved = kReplayTag;
+        if( SDL_PushEvent( &mNextEvent ) == false )
+        {
+            SDL_Log( "Unable to push replayed event! SDL error: %s\n", SDL_GetError() );
+        }
+        SDL_zero( mNextEvent );
+    }
 }
 
-bool LTimer::isPaused() 
+bool LInputReplayer::isLiveInput( const SDL_Event& e )
 {
-    return mPaused;
+    //Quitting still works so a replay can be stopped early
+    return isReplaying() && e.common.reserved != kReplayTag &&
+        e.type != SDL_EVENT_QUIT && LInputRecorder::getEventSize( e.type ) != 0;
 }
 
-bool LTimer::isStarted()
+template<typename T>
+bool LInputReplayer::read( T& value )
 {
-    return mStarted;
+    if( mPosition + sizeof( T ) > mLog.size() )
+    {
+        return false;
+    }
+    SDL_memcpy( &value, mLog.data() + mPosition, sizeof( T ) );
+    mPosition += sizeof( T );
+    return true;
 }
 
 //LButton Implementation
@@ -538,6 +2226,8 @@ void LTexture::destroy()
 
 void LTexture::render( float x, float y, SDL_FRect* clip, float width, float height, double degrees, SDL_FPoint* center, SDL_FlipMode flipMode )
 {
+    LProfileScope zone{ "LTexture::render" };
+
     //Set texture position
     SDL_FRect dstRect{ x, y, static_cast<float>( mWidth ), static_cast<float>( mHeight ) };
 
@@ -580,6 +2270,8 @@ void LTexture::setBlending( SDL_BlendMode blendMode )
 #if defined(SDL_TTF_MAJOR_VERSION)
 bool LTexture::loadFromRenderedText( std::string textureText, SDL_Color textColor )
 {
+    LProfileScope zone{ "LTexture::loadFromRenderedText" };
+
     //Clean up existing texture
     destroy();
 
@@ -617,6 +2309,13 @@ bool init()
     //Initialization flag
     bool success{ true };
 
+    //Use a display-less video driver and the software renderer
+    if( gHeadless )
+    {
+        SDL_SetHint( SDL_HINT_VIDEO_DRIVER, "offscreen,dummy" );
+        SDL_SetHint( SDL_HINT_RENDER_DRIVER, SDL_SOFTWARE_RENDERER );
+    }
+
     //Initialize SDL
     if( SDL_Init( SDL_INIT_VIDEO ) == false )
     {
@@ -633,10 +2332,10 @@ bool init()
         }
         else
         {
-            //Enable VSync
-            if( SDL_SetRenderVSync( gRenderer, 1 ) == false )
+            //Enable VSync unless running headless
+            if( SDL_SetRenderVSync( gRenderer, gHeadless ? SDL_RENDERER_VSYNC_DISABLED : 1 ) == false )
             {
-                SDL_Log( "Could not enable VSync! SDL error: %s\n", SDL_GetError() );
+                SDL_Log( "Could not set VSync! SDL error: %s\n", SDL_GetError() );
                 success = false;
             }
             
@@ -646,6 +2345,18 @@ bool init()
                 SDL_Log( "SDL_ttf could not initialize! SDL_ttf error: %s\n", SDL_GetError() );
                 success = false;
             }
+
+            //Start writing or load input to push back
+            if( gRecordInputPath != nullptr && gInputRecorder.start( gRecordInputPath ) == false )
+            {
+                SDL_Log( "Unable to record input!\n" );
+                success = false;
+            }
+            if( gReplayInputPath != nullptr && gInputReplayer.load( gReplayInputPath ) == false )
+            {
+                SDL_Log( "Unable to replay input!\n" );
+                success = false;
+            }
         }
     }
 
@@ -655,6 +2366,8 @@ bool init()
 
 bool loadMedia()
 {
+    LProfileScope zone{ "loadMedia" };
+
     //File loading flag
     bool success{ true };
 
@@ -690,6 +2403,19 @@ bool loadMedia()
 
 void close()
 {
+    //Write and free profiling zones
+    if( gProfiler.isEnabled() && gProfiler.writeChromeTrace( gTracePath ) )
+    {
+        SDL_Log( "Wrote trace to %s\n", gTracePath.c_str() );
+    }
+    gProfiler.destroy();
+
+    //Log input latency
+    gInputLatency.report();
+
+    //Finish input log
+    gInputRecorder.stop();
+
     //Clean up texture
     gDotTexture.destroy();
 
@@ -717,6 +2443,88 @@ int main( int argc, char* args[] )
     //Final exit code
     int exitCode{ 0 };
 
+    //Record profiling zones if a trace file is given, pick the clock and run without a display if asked
+    const char* clockName{ nullptr };
+    double timeScale{ 1.0 };
+    for( int i = 1; i < argc; ++i )
+    {
+        if( SDL_strcmp( args[ i ], "--trace" ) == 0 && i + 1 < argc )
+        {
+            gTracePath = args[ ++i ];
+            gProfiler.setEnabled( true );
+        }
+        else if( SDL_strcmp( args[ i ], "--headless" ) == 0 )
+        {
+            gHeadless = true;
+        }
+        else if( SDL_strcmp( args[ i ], "--frames" ) == 0 && i + 1 < argc )
+        {
+            gHeadlessFrames = SDL_atoi( args[ ++i ] );
+        }
+        else if( SDL_strcmp( args[ i ], "--clock" ) == 0 && i + 1 < argc )
+        {
+            clockName = args[ ++i ];
+        }
+        else if( SDL_strcmp( args[ i ], "--record-input" ) == 0 && i + 1 < argc )
+        {
+            gRecordInputPath = args[ ++i ];
+        }
+        else if( SDL_strcmp( args[ i ], "--replay-input" ) == 0 && i + 1 < argc )
+        {
+            gReplayInputPath = args[ ++i ];
+        }
+        else if( SDL_strcmp( args[ i ], "--time-scale" ) == 0 && i + 1 < argc )
+        {
+            clockName = clockName == nullptr ? "scaled" : clockName;
+            timeScale = SDL_atof( args[ ++i ] );
+        }
+    }
+
+    //Fall back to the default on bad counts
+    if( gHeadlessFrames <= 0 )
+    {
+        gHeadlessFrames = kDefaultHeadlessFrames;
+    }
+
+    //Replays run headless one simulation step per frame, which needs time that only moves when stepped
+    if( gReplayInputPath != nullptr )
+    {
+        gHeadless = true;
+        if( clockName != nullptr && SDL_strcmp( clockName, "stepped" ) != 0 )
+        {
+            SDL_Log( "Input replays run on the stepped clock, ignoring --clock %s\n", clockName );
+        }
+        clockName = "stepped";
+    }
+
+    //Headless runs step time a frame at a time so the simulation comes out the same every run
+    LScaledClock scaledClock{ gRealClock, 1.0 };
+    LSteppedClock steppedClock;
+    if( clockName == nullptr )
+    {
+        clockName = gHeadless ? "stepped" : "real";
+    }
+    if( SDL_strcmp( clockName, "stepped" ) == 0 )
+    {
+        gClock = &steppedClock;
+    }
+    else if( SDL_strcmp( clockName, "scaled" ) == 0 )
+    {
+        if( timeScale > 0.0 )
+        {
+            scaledClock.setScale( timeScale );
+            gClock = &scaledClock;
+        }
+        else
+        {
+            SDL_Log( "Time scale %g is not positive, using the real clock\n", timeScale );
+        }
+    }
+    else if( SDL_strcmp( clockName, "real" ) != 0 )
+    {
+        SDL_Log( "Unknown clock %s, using the real clock\n", clockName );
+    }
+
     //Initialize
     if( init() == false )
     {
@@ -747,14 +2555,42 @@ int main( int argc, char* args[] )
             bool fpsCapEnabled{ false };
 
             //Timer to cap frame rate
-            LTimer capTimer;
+            LTimer capTimer{ &gRealClock };
 
             //Dot we will be moving around on the screen
             Dot dot;
 
+            //Arrow keys and WASD move the dot
+            LInputActions actions;
+            actions.bind( SDL_SCANCODE_UP, eAction::MoveUp );
+            actions.bind( SDL_SCANCODE_DOWN, eAction::MoveDown );
+            actions.bind( SDL_SCANCODE_LEFT, eAction::MoveLeft );
+            actions.bind( SDL_SCANCODE_RIGHT, eAction::MoveRight );
+            actions.bind( SDL_SCANCODE_W, eAction::MoveUp );
+            actions.bind( SDL_SCANCODE_S, eAction::MoveDown );
+            actions.bind( SDL_SCANCODE_A, eAction::MoveLeft );
+            actions.bind( SDL_SCANCODE_D, eAction::MoveRight );
+            actions.bindAxis( eAxis::MoveX, eAction::MoveLeft, eAction::MoveRight );
+            actions.bindAxis( eAxis::MoveY, eAction::MoveUp, eAction::MoveDown );
+
+            //Waits for each frame deadline
+            LFramePacer framePacer;
+            framePacer.start( 1000000000 / kScreenFps );
+
+            //Steps the simulation at its own rate
+            LFixedTimestep simulation;
+            simulation.start( kSimulationHz );
+
+            //Lowers the frame rate while nothing is happening
+            LFrameGovernor governor;
+            governor.start( kScreenFps );
+
             //Time spent rendering
             Uint64 renderingNS{ 0 };
 
+            //Frames run so far, headless runs stop after gHeadlessFrames
+            int frameCount{ 0 };
+
             //In memory text stream
             std::stringstream timeText;
 
@@ -779,71 +2615,148 @@ int main( int argc, char* args[] )
             {
                 // Start frame time
                 capTimer.start();
+                LProfileScope frameZone{ "Frame" };
+
+                //Inject the input logged up to this simulation step
+                if( gInputReplayer.isReplaying() )
+                {
+                    gInputReplayer.pushFrameEvents( simulation.getStepCount() );
+                }
 
                 //Get event data
-                while( SDL_PollEvent( &e ) == true )
                 {
-                    //If event is quit type
-                    if( e.type == SDL_EVENT_QUIT )
+                    LProfileScope zone{ "Events" };
+                    actions.beginFrame();
+                    while( SDL_PollEvent( &e ) == true )
                     {
-                        //End the main loop
-                        quit = true;
+                        //Replays only see logged input
+                        if( gInputReplayer.isLiveInput( e ) )
+                        {
+                            continue;
+                        }
+
+                        //Log input with the simulation step it goes in before
+                        if( gInputRecorder.isRecording() )
+                        {
+                            gInputRecorder.recordEvent( e );
+                        }
+
+                        //If event is quit type
+                        if( e.type == SDL_EVENT_QUIT )
+                        {
+                            //End the main loop
+                            quit = true;
+                        }
+
+                        //Update action states
+                        actions.handleEvent( e );
+
+                        //Input brings back full rate, exposed windows need redrawing
+                        if( e.type == SDL_EVENT_KEY_DOWN || e.type == SDL_EVENT_KEY_UP || e.type == SDL_EVENT_MOUSE_MOTION ||
+                            e.type == SDL_EVENT_MOUSE_BUTTON_DOWN || e.type == SDL_EVENT_MOUSE_BUTTON_UP || e.type == SDL_EVENT_MOUSE_WHEEL )
+                        {
+                            governor.noteInput();
+                        }
+                        else if( e.type == SDL_EVENT_WINDOW_EXPOSED || e.type == SDL_EVENT_WINDOW_RESIZED )
+                        {
+                            governor.noteDirty();
+                        }
+
+                        //Reset start time on return keypress
+                        // else if( e.type == SDL_EVENT_KEY_DOWN )
+                        // {
+                        //      //VSync toggle
+                        //     if( e.key.key == SDLK_RETURN )
+                        //     {
+                        //         vsyncEnabled = !vsyncEnabled;
+                        //         SDL_SetRenderVSync( gRenderer, ( vsyncEnabled ) ? 1 : SDL_RENDERER_VSYNC_DISABLED );
+                        //     }
+                        //     //FPS cap toggle
+                        //     else if( e.key.key == SDLK_SPACE )
+                        //     {
+                        //         fpsCapEnabled = !fpsCapEnabled;
+                        //     }
+                        // }
+
+
+                        //Update screen
+
+                        // //On key press
+                        // else if( e.type == SDL_EVENT_KEY_DOWN )
+                        // {
+                        //
+                        // }
+                        //
+                        // //Handle button events
+                        // for( int i = 0; i < kButtonCount; ++i )
+                        // {
+                        //     buttons[ i ].handleEvent( &e );
+                        // }
                     }
 
-                    //Process dot events
-                    dot.handleEvent( e );
-
-                    //Reset start time on return keypress
-                    // else if( e.type == SDL_EVENT_KEY_DOWN )
-                    // {
-                    //      //VSync toggle
-                    //     if( e.key.key == SDLK_RETURN )
-                    //     {
-                    //         vsyncEnabled = !vsyncEnabled;
-                    //         SDL_SetRenderVSync( gRenderer, ( vsyncEnabled ) ? 1 : SDL_RENDERER_VSYNC_DISABLED );
-                    //     }
-                    //     //FPS cap toggle
-                    //     else if( e.key.key == SDLK_SPACE )
-                    //     {
-                    //         fpsCapEnabled = !fpsCapEnabled;
-                    //     }
-                    // }
-
+                    //Steer the dot from this frame's actions
+                    dot.handleActions( actions );
+                }
 
-                    //Update screen
+                //Run every simulation step that is due, none after quitting so a replay ends on the same step as its recording
+                simulation.beginFrame();
+                while( quit == false && simulation.step() )
+                {
+                    //Update dot
+                    dot.move( simulation.getStepSeconds() );
+                }
 
-                    // //On key press
-                    // else if( e.type == SDL_EVENT_KEY_DOWN )
-                    // {
-                    //
-                    // }
-                    //
-                    // //Handle button events
-                    // for( int i = 0; i < kButtonCount; ++i )
-                    // {
-                    //     buttons[ i ].handleEvent( &e );
-                    // }
+                //Queue this frame's input for the writer
+                if( gInputRecorder.isRecording() )
+                {
+                    gInputRecorder.endFrame( simulation.getStepCount() );
                 }
 
-                //Update dot
-                dot.move();
+                //Pick the frame rate from scene activity and have the pacer hold it, waking early for input
+                governor.update( dot.isMoving() );
+                framePacer.setPeriod( governor.getPeriodNS() );
+                framePacer.setWakeOnEvent( governor.getTarget() != LFrameGovernor::eTarget::Full );
 
-                //Fill the background
-                SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF,  0xFF );
-                SDL_RenderClear( gRenderer );
+                //Only draw frames that changed
+                if( governor.shouldRender() )
+                {
+                    //Fill the background
+                    SDL_SetRenderDrawColor( gRenderer, 0xFF, 0xFF, 0xFF,  0xFF );
+                    SDL_RenderClear( gRenderer );
 
-                //Render dot
-                dot.render();
+                    //Render dot
+                    dot.render( simulation.getAlpha() );
 
-                //Update screen
-                SDL_RenderPresent(gRenderer);
+                    //Update screen
+                    {
+                        LProfileScope zone{ "SDL_RenderPresent" };
+                        SDL_RenderPresent(gRenderer);
+                    }
+                    gInputLatency.presented();
+                    governor.rendered();
+                }
+
+                //Replays move time one step per frame so logged input lands between the same steps it was recorded between
+                if( gInputReplayer.isReplaying() )
+                {
+                    steppedClock.step( simulation.getStepNS() );
+                }
+                else
+                {
+                    //Wait for the frame deadline and log jitter every time the statistics window fills
+                    framePacer.wait();
+                    if( framePacer.getSampleCount() == LFramePacer::kJitterSamples )
+                    {
+                        framePacer.report();
+                        framePacer.clearStatistics();
+                    }
+                }
 
-                //If time remaining in frame
-                constexpr Uint64 nsPerFrame = 1000000000 / kScreenFps; 
-                Uint64 frameNs{ capTimer.getTicksNS() };
-                if ( frameNs < nsPerFrame)
+                //Stop headless runs after the requested count, replays once the log runs out
+                ++frameCount;
+                if( gInputReplayer.isReplaying() ? gInputReplayer.isFinished() : gHeadless && frameCount >= gHeadlessFrames )
                 {
-                    SDL_DelayNS(nsPerFrame - frameNs);
+                    quit = true;
                 }
 
                 //Fill the background
@@ -863,6 +2776,12 @@ int main( int argc, char* args[] )
                 //Update screen
                 // SDL_RenderPresent( gRenderer );
             } 
+
+            //Log time the simulation skipped to keep up
+            SDL_Log( "Fixed timestep dropped %.3f ms over %d frames\n", simulation.getDroppedNS() / 1000000.0, frameCount );
+
+            //Where the input left the dot, a replay matches the run it was recorded from
+            SDL_Log( "Dot at %.6f, %.6f after %d simulation steps\n", dot.getPosX(), dot.getPosY(), static_cast<int>( simulation.getStepCount() ) );
         }
     }
 
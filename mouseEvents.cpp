@@ -6,6 +6,8 @@
 #include <SDL3_image/SDL_image.h>
 #include <SDL3_ttf/SDL_ttf.h>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 /* Constants */
 //Screen dimension constants
@@ -37,6 +39,15 @@ class LButton
         //Sets top left position
         void setPosition( float x, float y );
 
+        //Gets top left position
+        SDL_FPoint getPosition() const;
+
+        //Checks if a point is on the button, edges included
+        bool contains( float x, float y ) const;
+
+        //Checks if the button shows anything but the mouse out sprite
+        bool isMouseOver() const;
+
         //Handles mouse event
         void handleEvent( SDL_Event* e );
     
@@ -59,6 +70,129 @@ class LButton
         eButtonSprite mCurrentSprite;
 };
 
+//Uniform grid over the screen that routes mouse events to the buttons under the cursor
+class LButtonIndex
+{
+    public:
+        //Grid cell size, points outside the screen fall in the nearest edge cell
+        static constexpr int kCellSize = 64;
+        static constexpr int kColumns = ( kScreenWidth + kCellSize - 1 ) / kCellSize;
+        static constexpr int kRows = ( kScreenHeight + kCellSize - 1 ) / kCellSize;
+
+        //Initializes empty index
+        LButtonIndex();
+
+        //Indexes buttons at their current positions, the array must outlive the index
+        void build( LButton* buttons, int count );
+
+        //Moves a button and updates only the cells it left and entered
+        void moveButton( int index, float x, float y );
+
+        //Sends a mouse event to the buttons in the cursor's cell and to buttons the cursor just left
+        void handleEvent( SDL_Event* e );
+
+    private:
+        //Gets the clamped cell range a button covers
+        void getCellRange( int index, int& x0, int& y0, int& x1, int& y1 ) const;
+
+        //Gets the clamped cell a point falls in
+        int getCell( float x, float y ) const;
+
+        //Adds a button to the cells it covers
+        void insert( int index );
+
+        //Removes a button from a cell range
+        void remove( int index, int x0, int y0, int x1, int y1 );
+
+        //Indexed buttons
+        LButton* mButtons;
+        int mCount;
+
+        //Button indices per cell
+        std::vector<int> mCells[ kColumns * kRows ];
+
+        //Buttons showing a mouse over sprite after the last event
+        std::vector<int> mHot;
+        std::vector<int> mNextHot;
+};
+
+//Kinds of input latency is tracked for
+enum class eInputType
+{
+    Key = 0,
+    MouseMotion = 1,
+    MouseButton = 2,
+    Count = 3
+};
+
+class LInputLatency
+{
+    public:
+        //Latencies kept per input type
+        static constexpr int kSamples = 1024;
+
+        //State changes waiting for a present per input type
+        static constexpr int kMaxPending = 64;
+
+        //Initializes variables
+        LInputLatency();
+
+        //Marks a state change caused by an event with that event's timestamp
+        void tag( eInputType type, Uint64 eventTimestampNs );
+
+        //Records the time from each tagged event to now, call right after SDL_RenderPresent returns
+        void presented();
+
+        //Logs the latency distribution for each input type
+        void report();
+
+    private:
+        //Timestamps of state changes not presented yet
+        Uint64 mPending[ static_cast<int>( eInputType::Count ) ][ kMaxPending ];
+        int mPendingCount[ static_cast<int>( eInputType::Count ) ];
+
+        //Recent latencies, ring per input type
+        Uint64 mSamples[ static_cast<int>( eInputType::Count ) ][ kSamples ];
+        int mSampleCount[ static_cast<int>( eInputType::Count ) ];
+        int mNextSample[ static_cast<int>( eInputType::Count ) ];
+};
+
+//One frame's events, with runs of mouse motion merged unless raw motion is on
+class LEventBatch
+{
+    public:
+        //Events the batch holds before growing
+        static constexpr int kReserve = 256;
+
+        //Initializes empty batch
+        LEventBatch();
+
+        //Keeps every motion sample when on
+        void setRawMotion( bool raw );
+        bool getRawMotion() const;
+
+        //Replaces the batch with the events now in the SDL queue, merged motion keeps its first sample's timestamp
+        void poll();
+
+        //Iterates the batch in queue order
+        SDL_Event* begin();
+        SDL_Event* end();
+
+        //Logs how many motion events were merged away
+        void report() const;
+
+    private:
+        //Events this frame
+        std::vector<SDL_Event> mEvents;
+
+        //Raw motion flag
+        bool mRawMotion;
+
+        //Motion events read and motion events handed on
+        Uint64 mMotionRead;
+        Uint64 mMotionKept;
+};
+
 
 
 
@@ -127,9 +261,74 @@ SDL_Renderer* gRenderer{ nullptr };
 //The directional images
 LTexture gButtonSpriteTexture;
 
+//Time from input to the frame showing it
+LInputLatency gInputLatency;
+
+//Events read each frame
+LEventBatch gEventBatch;
+
 
 
 /* Class Implementations */
+//LInputLatency Implementation
+LInputLatency::LInputLatency():
+    mPending{},
+    mPendingCount{},
+    mSamples{},
+    mSampleCount{},
+    mNextSample{}
+{
+
+}
+
+void LInputLatency::tag( eInputType type, Uint64 eventTimestampNs )
+{
+    //One event changing several things counts once, past the limit the oldest pending changes already give the worst case
+    int t{ static_cast<int>( type ) };
+    bool repeated{ mPendingCount[ t ] > 0 && mPending[ t ][ mPendingCount[ t ] - 1 ] == eventTimestampNs };
+    if( repeated == false && mPendingCount[ t ] < kMaxPending )
+    {
+        mPending[ t ][ mPendingCount[ t ]++ ] = eventTimestampNs;
+    }
+}
+
+void LInputLatency::presented()
+{
+    //Event timestamps come from the same clock as SDL_GetTicksNS
+    Uint64 now{ SDL_GetTicksNS() };
+    for( int t = 0; t < static_cast<int>( eInputType::Count ); ++t )
+    {
+        for( int i = 0; i < mPendingCount[ t ]; ++i )
+        {
+            mSamples[ t ][ mNextSample[ t ] ] = now > mPending[ t ][ i ] ? now - mPending[ t ][ i ] : 0;
+            mNextSample[ t ] = ( mNextSample[ t ] + 1 ) % kSamples;
+            mSampleCount[ t ] = SDL_min( mSampleCount[ t ] + 1, kSamples );
+        }
+        mPendingCount[ t ] = 0;
+    }
+}
+
+void LInputLatency::report()
+{
+    const char* names[ static_cast<int>( eInputType::Count ) ]{ "key", "mouse motion", "mouse button" };
+    for( int t = 0; t < static_cast<int>( eInputType::Count ); ++t )
+    {
+        int count{ mSampleCount[ t ] };
+        if( count == 0 )
+        {
+            continue;
+        }
+
+        //Sort a copy for percentiles
+        Uint64 sorted[ kSamples ];
+        std::copy( mSamples[ t ], mSamples[ t ] + count, sorted );
+        std::sort( sorted, sorted + count );
+        SDL_Log( "Input to present latency, %s: %d samples, p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\n", names[ t ], count,
+            sorted[ ( count - 1 ) * 50 / 100 ] / 1000000.0, sorted[ ( count - 1 ) * 95 / 100 ] / 1000000.0,
+            sorted[ ( count - 1 ) * 99 / 100 ] / 1000000.0, sorted[ count - 1 ] / 1000000.0 );
+    }
+}
+
 //LButton Implementation
 LButton::LButton():
     mPosition{ 0.f, 0.f },
@@ -144,39 +343,36 @@ void LButton::setPosition( float x, float y )
     mPosition.y = y;
 }
 
+SDL_FPoint LButton::getPosition() const
+{
+    return mPosition;
+}
+
+bool LButton::contains( float x, float y ) const
+{
+    //Evaluate all four edges without short circuit branches
+    return ( x >= mPosition.x ) & ( x <= mPosition.x + kButtonWidth ) & ( y >= mPosition.y ) & ( y <= mPosition.y + kButtonHeight );
+}
+
+bool LButton::isMouseOver() const
+{
+    return mCurrentSprite != eButtonSprite::MouseOut;
+}
+
 void LButton::handleEvent( SDL_Event* e )
 {
     //If mouse event happened
     if( e->type == SDL_EVENT_MOUSE_MOTION || e->type == SDL_EVENT_MOUSE_BUTTON_DOWN || e->type == SDL_EVENT_MOUSE_BUTTON_UP )
     {
-        //Get mouse position
-        float x = -1.f, y = -1.f;
-        SDL_GetMouseState( &x, &y );
-
-        //Check if mouse is in button
-        bool inside = true;
+        //Sprite before the event
+        eButtonSprite previousSprite{ mCurrentSprite };
 
-        //Mouse is left of the button
-        if( x < mPosition.x )
-        {
-            inside = false;
-        }
-        //Mouse is right of the button
-        else if( x > mPosition.x + kButtonWidth )
-        {
-            inside = false;
-        }
-        //Mouse above the button
-        else if( y < mPosition.y )
-        {
-            inside = false;
-        }
-        //Mouse below the button
-        else if( y > mPosition.y + kButtonHeight )
-        {
-            inside = false;
-        }
+        //Get mouse position from the event itself
+        float x = e->type == SDL_EVENT_MOUSE_MOTION ? e->motion.x : e->button.x;
+        float y = e->type == SDL_EVENT_MOUSE_MOTION ? e->motion.y : e->button.y;
 
+        //Check if mouse is in button
+        bool inside = contains( x, y );
 
         //Mouse is outside button
         if( !inside )
@@ -202,6 +398,12 @@ void LButton::handleEvent( SDL_Event* e )
                     break;
             }
         }
+
+        //Track latency for events that changed the button
+        if( mCurrentSprite != previousSprite )
+        {
+            gInputLatency.tag( e->type == SDL_EVENT_MOUSE_MOTION ? eInputType::MouseMotion : eInputType::MouseButton, e->common.timestamp );
+        }
     }
 }
 
@@ -221,6 +423,206 @@ void LButton::render()
 }
 
 
+//LButtonIndex Implementation
+LButtonIndex::LButtonIndex():
+    mButtons{ nullptr },
+    mCount{ 0 }
+{
+
+}
+
+void LButtonIndex::build( LButton* buttons, int count )
+{
+    //Clear old index
+    for( std::vector<int>& cell : mCells )
+    {
+        cell.clear();
+    }
+    mHot.clear();
+
+    //Index every button
+    mButtons = buttons;
+    mCount = count;
+    for( int i = 0; i < mCount; ++i )
+    {
+        insert( i );
+        if( mButtons[ i ].isMouseOver() )
+        {
+            mHot.push_back( i );
+        }
+    }
+}
+
+void LButtonIndex::moveButton( int index, float x, float y )
+{
+    //Skip the cell update if the button stays in the same cells
+    int oldX0 = 0, oldY0 = 0, oldX1 = 0, oldY1 = 0;
+    getCellRange( index, oldX0, oldY0, oldX1, oldY1 );
+    mButtons[ index ].setPosition( x, y );
+    int newX0 = 0, newY0 = 0, newX1 = 0, newY1 = 0;
+    getCellRange( index, newX0, newY0, newX1, newY1 );
+    if( oldX0 == newX0 && oldY0 == newY0 && oldX1 == newX1 && oldY1 == newY1 )
+    {
+        return;
+    }
+
+    //Take the button out of its old cells and put it in the new ones
+    remove( index, oldX0, oldY0, oldX1, oldY1 );
+    insert( index );
+}
+
+void LButtonIndex::handleEvent( SDL_Event* e )
+{
+    //Only mouse events are routed
+    if( e->type != SDL_EVENT_MOUSE_MOTION && e->type != SDL_EVENT_MOUSE_BUTTON_DOWN && e->type != SDL_EVENT_MOUSE_BUTTON_UP )
+    {
+        return;
+    }
+
+    //Get mouse position from the event itself
+    float x = e->type == SDL_EVENT_MOUSE_MOTION ? e->motion.x : e->button.x;
+    float y = e->type == SDL_EVENT_MOUSE_MOTION ? e->motion.y : e->button.y;
+
+    //Handle the candidates in the cursor's cell
+    mNextHot.clear();
+    for( int i : mCells[ getCell( x, y ) ] )
+    {
+        mButtons[ i ].handleEvent( e );
+        if( mButtons[ i ].isMouseOver() )
+        {
+            mNextHot.push_back( i );
+        }
+    }
+
+    //Let buttons the cursor left go back to mouse out
+    for( int i : mHot )
+    {
+        if( std::find( mNextHot.begin(), mNextHot.end(), i ) == mNextHot.end() )
+        {
+            mButtons[ i ].handleEvent( e );
+        }
+    }
+    mHot.swap( mNextHot );
+}
+
+void LButtonIndex::getCellRange( int index, int& x0, int& y0, int& x1, int& y1 ) const
+{
+    SDL_FPoint position{ mButtons[ index ].getPosition() };
+    x0 = std::clamp( static_cast<int>( SDL_floorf( position.x / kCellSize ) ), 0, kColumns - 1 );
+    y0 = std::clamp( static_cast<int>( SDL_floorf( position.y / kCellSize ) ), 0, kRows - 1 );
+    x1 = std::clamp( static_cast<int>( SDL_floorf( ( position.x + LButton::kButtonWidth ) / kCellSize ) ), 0, kColumns - 1 );
+    y1 = std::clamp( static_cast<int>( SDL_floorf( ( position.y + LButton::kButtonHeight ) / kCellSize ) ), 0, kRows - 1 );
+}
+
+int LButtonIndex::getCell( float x, float y ) const
+{
+    int cx = std::clamp( static_cast<int>( SDL_floorf( x / kCellSize ) ), 0, kColumns - 1 );
+    int cy = std::clamp( static_cast<int>( SDL_floorf( y / kCellSize ) ), 0, kRows - 1 );
+    return cy * kColumns + cx;
+}
+
+void LButtonIndex::insert( int index )
+{
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    getCellRange( index, x0, y0, x1, y1 );
+    for( int cy = y0; cy <= y1; ++cy )
+    {
+        for( int cx = x0; cx <= x1; ++cx )
+        {
+            mCells[ cy * kColumns + cx ].push_back( index );
+        }
+    }
+}
+
+void LButtonIndex::remove( int index, int x0, int y0, int x1, int y1 )
+{
+    for( int cy = y0; cy <= y1; ++cy )
+    {
+        for( int cx = x0; cx <= x1; ++cx )
+        {
+            std::vector<int>& cell = mCells[ cy * kColumns + cx ];
+            if( auto it = std::find( cell.begin(), cell.end(), index ); it != cell.end() )
+            {
+                *it = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
+
+
+//LEventBatch Implementation
+LEventBatch::LEventBatch():
+    mRawMotion{ false },
+    mMotionRead{ 0 },
+    mMotionKept{ 0 }
+{
+    mEvents.reserve( kReserve );
+}
+
+void LEventBatch::setRawMotion( bool raw )
+{
+    mRawMotion = raw;
+}
+
+bool LEventBatch::getRawMotion() const
+{
+    return mRawMotion;
+}
+
+void LEventBatch::poll()
+{
+    mEvents.clear();
+
+    SDL_Event e;
+    while( SDL_PollEvent( &e ) == true )
+    {
+        if( e.type == SDL_EVENT_MOUSE_MOTION )
+        {
+            mMotionRead++;
+
+            //Fold into the previous event if it is motion from the same mouse in the same window
+            if( !mRawMotion && !mEvents.empty() )
+            {
+                SDL_Event& last = mEvents.back();
+                if( last.type == SDL_EVENT_MOUSE_MOTION && last.motion.which == e.motion.which && last.motion.windowID == e.motion.windowID )
+                {
+                    //Take the newest position and buttons, sum the relative motion and keep the first sample's time so latency counts from the oldest input
+                    float xrel = last.motion.xrel + e.motion.xrel;
+                    float yrel = last.motion.yrel + e.motion.yrel;
+                    Uint64 timestamp = last.motion.timestamp;
+                    last.motion = e.motion;
+                    last.motion.xrel = xrel;
+                    last.motion.yrel = yrel;
+                    last.motion.timestamp = timestamp;
+                    continue;
+                }
+            }
+
+            mMotionKept++;
+        }
+
+        //Anything else keeps its place so button and key order relative to motion holds
+        mEvents.push_back( e );
+    }
+}
+
+SDL_Event* LEventBatch::begin()
+{
+    return mEvents.data();
+}
+
+SDL_Event* LEventBatch::end()
+{
+    return mEvents.data() + mEvents.size();
+}
+
+void LEventBatch::report() const
+{
+    SDL_Log( "Mouse motion: %llu events read, %llu handled%s\n", static_cast<unsigned long long>( mMotionRead ), static_cast<unsigned long long>( mMotionKept ), mRawMotion ? " (raw)" : "" );
+}
+
+
 //LTexture Implementation
 LTexture::LTexture():
     //Initialize texture variables
@@ -433,6 +835,10 @@ bool loadMedia()
 
 void close()
 {
+    //Log input latency and motion coalescing
+    gInputLatency.report();
+    gEventBatch.report();
+
     //Clean up texture
     //gTextTexture.destroy();
 
@@ -460,6 +866,15 @@ int main( int argc, char* args[] )
     //Final exit code
     int exitCode{ 0 };
 
+    //Hand every motion sample to the buttons if asked
+    for( int i = 1; i < argc; ++i )
+    {
+        if( SDL_strcmp( args[ i ], "--raw-motion" ) == 0 )
+        {
+            gEventBatch.setRawMotion( true );
+        }
+    }
+
     //Initialize
     if( init() == false )
     {
@@ -479,10 +894,6 @@ int main( int argc, char* args[] )
             //The quit flag
             bool quit{ false };
 
-            //The event data
-            SDL_Event e;
-            SDL_zero( e );
-
             //Rotation degrees
             double degrees = 0.0;
 
@@ -492,17 +903,20 @@ int main( int argc, char* args[] )
             //Place buttons
             constexpr int kButtonCount = 4;
             LButton buttons[ kButtonCount ];
-            buttons[ 0 ].setPosition(                                    0,                                      0 );
-            buttons[ 1 ].setPosition( kScreenWidth - LButton::kButtonWidth,                                      0 );
-            buttons[ 2 ].setPosition(                                    0, kScreenHeight - LButton::kButtonHeight );
-            buttons[ 3 ].setPosition( kScreenWidth - LButton::kButtonWidth, kScreenHeight - LButton::kButtonHeight );
+            LButtonIndex buttonIndex;
+            buttonIndex.build( buttons, kButtonCount );
+            buttonIndex.moveButton( 0,                                    0,                                      0 );
+            buttonIndex.moveButton( 1, kScreenWidth - LButton::kButtonWidth,                                      0 );
+            buttonIndex.moveButton( 2,                                    0, kScreenHeight - LButton::kButtonHeight );
+            buttonIndex.moveButton( 3, kScreenWidth - LButton::kButtonWidth, kScreenHeight - LButton::kButtonHeight );
 
 
             //The main loop
             while( quit == false )
             {
                 //Get event data
-                while( SDL_PollEvent( &e ) == true )
+                gEventBatch.poll();
+                for( SDL_Event& e : gEventBatch )
                 {
                     //If event is quit type
                     if( e.type == SDL_EVENT_QUIT )
@@ -518,10 +932,7 @@ int main( int argc, char* args[] )
                     }
 
                     //Handle button events
-                    for( int i = 0; i < kButtonCount; ++i )
-                    {
-                        buttons[ i ].handleEvent( &e );
-                    }
+                    buttonIndex.handleEvent( &e );
                 }
 
                 //Fill the background
@@ -540,6 +951,7 @@ int main( int argc, char* args[] )
 
                 //Update screen
                 SDL_RenderPresent( gRenderer );
+                gInputLatency.presented();
             } 
         }
     }
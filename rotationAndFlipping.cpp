@@ -5,6 +5,8 @@
 #include <SDL3/SDL_surface.h>
 #include <SDL3_image/SDL_image.h>
 #include <string>
+#include <vector>
+#include <algorithm>
 
 /* Constants */
 //Screen dimension constants
@@ -44,6 +46,15 @@ public:
     //Cleans up texture
     void destroy();
 
+    //Pre-renders rotations every stepDegrees into an atlas so matching angles draw as plain blits
+    bool enableRotationCache( double stepDegrees );
+
+    //Frees the rotation atlas
+    void destroyRotationCache();
+
+    //Marks every cached rotation for re-rendering, call when render target contents are lost
+    void invalidateRotationCache();
+
     //Draws texture
     void render( float x, float y, SDL_FRect* clip = nullptr, float width = kOriginalSize, float height = kOriginalSize, double degrees = 0.0, SDL_FPoint* center = nullptr, SDL_FlipMode flipMode = SDL_FLIP_NONE );
 
@@ -53,12 +64,31 @@ public:
     bool isLoaded();
 
 private:
+    //Flip modes with a row in the rotation atlas
+    static constexpr int kCachedFlipModes = 3;
+
+    //Gets the atlas cell for an angle and flip, rendering it on first use, or -1 if not cacheable
+    int getRotationCell( double degrees, SDL_FlipMode flipMode );
+
     //Contains texture data
     SDL_Texture* mTexture;
 
     //Texture dimensions
     int mWidth;
     int mHeight;
+
+    //Atlas of pre-rendered rotations, one column per step and one row per flip mode
+    SDL_Texture* mRotationAtlas;
+
+    //Angle between cached rotations and how many fit in a turn
+    double mRotationStep;
+    int mRotationSteps;
+
+    //Size of the square cell that fits the sprite at any angle
+    int mRotationCellSize;
+
+    //Which atlas cells have been rendered
+    std::vector<bool> mRotationCellReady;
 };
 
 
@@ -81,7 +111,11 @@ LTexture::LTexture():
     //Initialize texture variables
     mTexture{ nullptr },
     mWidth{ 0 },
-    mHeight{ 0 }
+    mHeight{ 0 },
+    mRotationAtlas{ nullptr },
+    mRotationStep{ 0.0 },
+    mRotationSteps{ 0 },
+    mRotationCellSize{ 0 }
 {
 
 }
@@ -150,6 +184,9 @@ bool LTexture::isLoaded()
 
 void LTexture::destroy()
 {
+    //Clean up rotations
+    destroyRotationCache();
+
     //Clean up texture
     SDL_DestroyTexture( mTexture );
     mTexture = nullptr;
@@ -157,6 +194,110 @@ void LTexture::destroy()
     mHeight = 0;
 }
 
+bool LTexture::enableRotationCache( double stepDegrees )
+{
+    //Clean up old atlas
+    destroyRotationCache();
+
+    //Steps have to divide a full turn evenly
+    int steps{ static_cast<int>( SDL_round( 360.0 / stepDegrees ) ) };
+    if( mTexture == nullptr || steps <= 0 || SDL_fabs( steps * stepDegrees - 360.0 ) > 1e-6 )
+    {
+        SDL_Log( "Unable to cache rotations every %f degrees!\n", stepDegrees );
+        return false;
+    }
+
+    //Cells are squares as wide as the sprite's diagonal so any angle fits
+    int cellSize{ static_cast<int>( SDL_ceil( SDL_sqrt( static_cast<double>( mWidth ) * mWidth + static_cast<double>( mHeight ) * mHeight ) ) ) };
+    if( mRotationAtlas = SDL_CreateTexture( gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, cellSize * steps, cellSize * kCachedFlipModes ); mRotationAtlas == nullptr )
+    {
+        SDL_Log( "Unable to create rotation atlas! SDL error: %s\n", SDL_GetError() );
+        return false;
+    }
+    SDL_SetTextureBlendMode( mRotationAtlas, SDL_BLENDMODE_BLEND );
+
+    //Cells are rendered lazily on first use
+    mRotationStep = stepDegrees;
+    mRotationSteps = steps;
+    mRotationCellSize = cellSize;
+    mRotationCellReady.assign( steps * kCachedFlipModes, false );
+
+    return true;
+}
+
+void LTexture::destroyRotationCache()
+{
+    SDL_DestroyTexture( mRotationAtlas );
+    mRotationAtlas = nullptr;
+    mRotationStep = 0.0;
+    mRotationSteps = 0;
+    mRotationCellSize = 0;
+    mRotationCellReady.clear();
+}
+
+void LTexture::invalidateRotationCache()
+{
+    std::fill( mRotationCellReady.begin(), mRotationCellReady.end(), false );
+}
+
+int LTexture::getRotationCell( double degrees, SDL_FlipMode flipMode )
+{
+    //Only the plain flip modes have rows
+    if( mRotationAtlas == nullptr || flipMode < SDL_FLIP_NONE || static_cast<int>( flipMode ) >= kCachedFlipModes )
+    {
+        return -1;
+    }
+
+    //Angle has to land on a cached step
+    double step{ SDL_fmod( degrees, 360.0 ) / mRotationStep };
+    double nearestStep{ SDL_round( step ) };
+    if( SDL_fabs( step - nearestStep ) > 1e-6 )
+    {
+        return -1;
+    }
+    int column{ static_cast<int>( nearestStep ) % mRotationSteps };
+    if( column < 0 )
+    {
+        column += mRotationSteps;
+    }
+    int cell{ static_cast<int>( flipMode ) * mRotationSteps + column };
+
+    //Render cell on first use
+    if( mRotationCellReady[ cell ] == false )
+    {
+        //Draw into the atlas without disturbing the current target or draw state
+        SDL_Texture* oldTarget{ SDL_GetRenderTarget( gRenderer ) };
+        SDL_BlendMode oldBlendMode{ SDL_BLENDMODE_NONE };
+        Uint8 oldR{ 0 }, oldG{ 0 }, oldB{ 0 }, oldA{ 0 };
+        SDL_GetRenderDrawBlendMode( gRenderer, &oldBlendMode );
+        SDL_GetRenderDrawColor( gRenderer, &oldR, &oldG, &oldB, &oldA );
+        SDL_SetRenderTarget( gRenderer, mRotationAtlas );
+
+        //Clear the cell to transparent
+        SDL_FRect cellRect{ static_cast<float>( column * mRotationCellSize ), static_cast<float>( static_cast<int>( flipMode ) * mRotationCellSize ), static_cast<float>( mRotationCellSize ), static_cast<float>( mRotationCellSize ) };
+        SDL_SetRenderDrawBlendMode( gRenderer, SDL_BLENDMODE_NONE );
+        SDL_SetRenderDrawColor( gRenderer, 0x00, 0x00, 0x00, 0x00 );
+        SDL_RenderFillRect( gRenderer, &cellRect );
+
+        //Rotate the sprite about the cell center, on whole pixels so linear filtering doesn't blur it
+        SDL_FRect spriteRect{ cellRect.x + ( mRotationCellSize - mWidth ) / 2, cellRect.y + ( mRotationCellSize - mHeight ) / 2, static_cast<float>( mWidth ), static_cast<float>( mHeight ) };
+        SDL_BlendMode spriteBlendMode{ SDL_BLENDMODE_BLEND };
+        SDL_GetTextureBlendMode( mTexture, &spriteBlendMode );
+        SDL_SetTextureBlendMode( mTexture, SDL_BLENDMODE_NONE );
+        SDL_RenderTextureRotated( gRenderer, mTexture, nullptr, &spriteRect, column * mRotationStep, nullptr, flipMode );
+        SDL_SetTextureBlendMode( mTexture, spriteBlendMode );
+
+        //Restore state
+        SDL_SetRenderTarget( gRenderer, oldTarget );
+        SDL_SetRenderDrawBlendMode( gRenderer, oldBlendMode );
+        SDL_SetRenderDrawColor( gRenderer, oldR, oldG, oldB, oldA );
+
+        mRotationCellReady[ cell ] = true;
+    }
+
+    return cell;
+}
+
 void LTexture::render( float x, float y, SDL_FRect* clip, float width, float height, double degrees, SDL_FPoint* center, SDL_FlipMode flipMode )
 {
     //Set texture position
@@ -179,6 +320,18 @@ void LTexture::render( float x, float y, SDL_FRect* clip, float width, float hei
         dstRect.h = height;
     }
 
+    //Whole, unscaled sprites turning about their middle can come from the rotation atlas
+    bool centered{ center == nullptr || ( center->x == dstRect.w / 2.f && center->y == dstRect.h / 2.f ) };
+    bool unscaled{ dstRect.w == static_cast<float>( mWidth ) && dstRect.h == static_cast<float>( mHeight ) };
+    if( int cell = ( clip == nullptr && centered && unscaled ) ? getRotationCell( degrees, flipMode ) : -1; cell >= 0 )
+    {
+        //Blit the cell back by the same whole pixel offset the sprite was drawn into it at
+        SDL_FRect cellRect{ static_cast<float>( ( cell % mRotationSteps ) * mRotationCellSize ), static_cast<float>( ( cell / mRotationSteps ) * mRotationCellSize ), static_cast<float>( mRotationCellSize ), static_cast<float>( mRotationCellSize ) };
+        SDL_FRect cellDstRect{ dstRect.x - ( mRotationCellSize - mWidth ) / 2, dstRect.y - ( mRotationCellSize - mHeight ) / 2, cellRect.w, cellRect.h };
+        SDL_RenderTexture( gRenderer, mRotationAtlas, &cellRect, &cellDstRect );
+        return;
+    }
+
     //Render texture
     SDL_RenderTextureRotated( gRenderer, mTexture, clip, &dstRect, degrees, center, flipMode );
 }
@@ -221,6 +374,11 @@ bool loadMedia()
         SDL_Log( "Unable to load foo image!\n");
         success = false;
     }
+    //Cache the ten 36 degree orientations the arrow turns through
+    else if( gArrowTexture.enableRotationCache( 36.0 ) == false )
+    {
+        SDL_Log( "Unable to cache arrow rotations, drawing them directly\n" );
+    }
 
     return success;
 }
@@ -289,6 +447,21 @@ int main( int argc, char* args[] )
                         quit = true;
                     }
 
+                    //Render target contents were lost, redraw cached rotations on next use
+                    else if( e.type == SDL_EVENT_RENDER_TARGETS_RESET )
+                    {
+                        gArrowTexture.invalidateRotationCache();
+                    }
+
+                    //Every texture was lost, reload them
+                    else if( e.type == SDL_EVENT_RENDER_DEVICE_RESET )
+                    {
+                        if( loadMedia() == false )
+                        {
+                            quit = true;
+                        }
+                    }
+
                     //On key press
                     else if( e.type == SDL_EVENT_KEY_DOWN )
                     {
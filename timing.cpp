@@ -26,6 +26,56 @@ bool loadMedia();
 void close();
 
 
+class LClock
+{
+    public:
+        //Cleans up the clock
+        virtual ~LClock() = default;
+
+        //Gets the clock's time
+        virtual Uint64 getTicksNS() = 0;
+
+        //Waits for an amount of the clock's time
+        virtual void delayNS( Uint64 ns ) = 0;
+
+        //Checks if time only moves when asked to, busy waiting on these never ends
+        virtual bool isVirtual();
+};
+
+class LRealClock : public LClock
+{
+    public:
+        //Wall clock time since SDL started
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+};
+
+class LScaledClock : public LClock
+{
+    public:
+        //Initializes variables
+        LScaledClock( LClock& source, double scale );
+
+        //Changes speed without making time jump
+        void setScale( double scale );
+        double getScale();
+
+        //Source time multiplied by the scale
+        Uint64 getTicksNS() override;
+        void delayNS( Uint64 ns ) override;
+
+    private:
+        //Clock being scaled
+        LClock& mSource;
+
+        //Time multiplier
+        double mScale;
+
+        //Source and scaled time when the scale last changed
+        Uint64 mSourceAnchor;
+        Uint64 mTicksAnchor;
+};
+
 class LButton
 {
     public:
@@ -129,9 +179,68 @@ TTF_Font* gFont{ nullptr };
 //The directional images
 LTexture gTimeTextTexture;
 
+//Wall clock
+LRealClock gRealClock;
+
+//Clock the stopwatch reads, scaled with --time-scale
+LClock* gClock{ &gRealClock };
+
 
 
 /* Class Implementations */
+//LClock Implementation
+bool LClock::isVirtual()
+{
+    return false;
+}
+
+
+//LRealClock Implementation
+Uint64 LRealClock::getTicksNS()
+{
+    return SDL_GetTicksNS();
+}
+
+void LRealClock::delayNS( Uint64 ns )
+{
+    SDL_DelayNS( ns );
+}
+
+
+//LScaledClock Implementation
+LScaledClock::LScaledClock( LClock& source, double scale ):
+    mSource( source ),
+    mScale{ scale },
+    mSourceAnchor{ source.getTicksNS() },
+    mTicksAnchor{ 0 }
+{
+
+}
+
+void LScaledClock::setScale( double scale )
+{
+    //Keep the time so far and scale from here on
+    mTicksAnchor = getTicksNS();
+    mSourceAnchor = mSource.getTicksNS();
+    mScale = scale;
+}
+
+double LScaledClock::getScale()
+{
+    return mScale;
+}
+
+Uint64 LScaledClock::getTicksNS()
+{
+    return mTicksAnchor + static_cast<Uint64>( ( mSource.getTicksNS() - mSourceAnchor ) * mScale );
+}
+
+void LScaledClock::delayNS( Uint64 ns )
+{
+    mSource.delayNS( static_cast<Uint64>( ns / mScale ) );
+}
+
+
 //LButton Implementation
 LButton::LButton():
     mPosition{ 0.f, 0.f },
@@ -477,6 +586,25 @@ int main( int argc, char* args[] )
     //Final exit code
     int exitCode{ 0 };
 
+    //Run the stopwatch faster or slower than real time if asked
+    LScaledClock scaledClock{ gRealClock, 1.0 };
+    for( int i = 1; i < argc; ++i )
+    {
+        if( SDL_strcmp( args[ i ], "--time-scale" ) == 0 && i + 1 < argc )
+        {
+            double scale{ SDL_atof( args[ ++i ] ) };
+            if( scale > 0.0 )
+            {
+                scaledClock.setScale( scale );
+                gClock = &scaledClock;
+            }
+            else
+            {
+                SDL_Log( "Time scale %s is not positive, using the real clock\n", args[ i ] );
+            }
+        }
+    }
+
     //Initialize
     if( init() == false )
     {
@@ -538,14 +666,14 @@ int main( int argc, char* args[] )
                     else if( e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_RETURN )
                     {
                         //Set the new start time
-                        startTime = SDL_GetTicks();
+                        startTime = gClock->getTicksNS() / 1000000;
                     }
 
                     //Reset start time on return keypress
                     else if( e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_RETURN )
                     {
                         //Set the new start time
-                        startTime = SDL_GetTicks();
+                        startTime = gClock->getTicksNS() / 1000000;
                     }
 
 
@@ -569,7 +697,7 @@ int main( int argc, char* args[] )
                 {
                     //Update text
                     timeText.str("");
-                    timeText << "Milliseconds since start time " << SDL_GetTicks() - startTime; 
+                    timeText << "Milliseconds since start time " << gClock->getTicksNS() / 1000000 - startTime; 
                     SDL_Color textColor{ 0x00, 0x00, 0x00, 0xFF };
                     gTimeTextTexture.loadFromRenderedText( timeText.str().c_str(), textColor );
                 }